@@ -0,0 +1,275 @@
+#!/bin/bash
+
+# Measure the compile time and code size cost of using tinyformat, emitting
+# the results as JSON so that regressions can be tracked.  Call as
+#
+#   compile_benchmark.sh [-n units] [-c calls] [-o out.json] [-m "modes"] $CXX [flags...]
+#
+# A project of `units` translation units (default 20) is generated, each
+# containing `calls` formatting calls (default 40) with a deterministic but
+# varied mix of argument types and counts, format string lengths and output
+# functions, including user defined types formatted with operator<< and
+# tinyformatTo().  The project is then built in each of the given modes
+# (default "cxx98 cxx11": C++98 with the macro generated overloads, and C++11
+# with variadic templates; "cxx20" includes the header and "cxx20_module"
+# imports the module from tinyformat.cppm instead, which needs g++ 14 or
+# clang++ 16 or later), recording for each translation unit the compile
+# time, object size and the number of formatValue() and FormatArg member
+# template instantiations, and for the whole project the link time and
+# executable size.  Extra flags such as -O2 are passed to every compile.
+
+units=20
+calls=40
+output=compile_benchmark.json
+modes="cxx98 cxx11"
+while getopts "n:c:o:m:" opt ; do
+    case $opt in
+        n) units=$OPTARG ;;
+        c) calls=$OPTARG ;;
+        o) output=$OPTARG ;;
+        m) modes=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND-1))
+if [ $# -lt 1 ] ; then
+    echo "usage: $0 [-n units] [-c calls] [-o out.json] [-m modes] CXX [flags...]" 1>&2
+    exit 1
+fi
+
+srcdir=$(cd "$(dirname "$0")" && pwd)
+workdir=_compile_benchmark_tmp
+rm -rf $workdir
+mkdir -p $workdir
+
+
+#------------------------------------------------------------------------------
+# Generate the project
+
+cat > $workdir/bench_types.h <<'EOF'
+#include <iostream>
+#include <string>
+#ifdef BENCH_USE_MODULE
+import tinyformat;
+#else
+#include "tinyformat.h"
+#endif
+
+// User type formatted with operator<<
+struct Point { int x, y; };
+inline std::ostream& operator<<(std::ostream& out, const Point& p)
+{
+    return out << '(' << p.x << ", " << p.y << ')';
+}
+
+// User type formatted with tinyformatTo()
+namespace bench {
+struct Money { long cents; };
+inline void tinyformatTo(tfm::Sink& out, const tfm::FormatSpec&, const Money& m)
+{
+    tfm::format(out, "$%d.%02d", m.cents/100, m.cents%100);
+}
+}
+EOF
+
+# Argument types: value expression and matching conversion
+argValues=(  "i"  "l"   "u"  "d"    "f"    "s"  "ss" "c"  "b"  "p"  "ll"   "u"    "pt" "money")
+argConvs=(   "%d" "%ld" "%u" "%.3f" "%g"   "%s" "%s" "%c" "%s" "%p" "%lld" "%08x" "%s" "%s")
+words=(error warning request reply connection timeout "retrying in" status
+       "queue depth" "bytes sent" latency user session "cache miss" shard)
+
+# Deterministic pseudo random numbers
+RANDOM=12345
+
+for ((u=0; u<units; u++)) ; do
+    n=$(printf "%03d" $u)
+    f=$workdir/unit_$n.cpp
+    {
+        echo '#include "bench_types.h"'
+        echo
+        echo "void benchUnit$n(std::string& str, char* buf, int i, long l, unsigned u, double d,"
+        echo "                 float f, const char* s, const std::string& ss, char c, bool b,"
+        echo "                 void* p, long long ll, Point pt, bench::Money money)"
+        echo "{"
+        for ((k=0; k<calls; k++)) ; do
+            nargs=$((1 + RANDOM % 6))
+            fmt=""
+            args=""
+            nwords=$((RANDOM % 4))
+            for ((w=0; w<nwords; w++)) ; do
+                fmt="$fmt${words[$((RANDOM % ${#words[@]}))]} "
+            done
+            for ((a=0; a<nargs; a++)) ; do
+                t=$((RANDOM % ${#argValues[@]}))
+                [ $a -gt 0 ] && fmt="$fmt, "
+                fmt="$fmt${words[$((RANDOM % ${#words[@]}))]}=${argConvs[$t]}"
+                args="$args, ${argValues[$t]}"
+            done
+            case $((RANDOM % 4)) in
+                0) echo "    str += tfm::format(\"$fmt\"$args);" ;;
+                1) echo "    tfm::formatTo(buf, 256, \"$fmt\"$args);" ;;
+                2) echo "    tfm::format(std::cerr, \"$fmt\\n\"$args);" ;;
+                3) echo "    tfm::printfln(\"$fmt\"$args);" ;;
+            esac
+        done
+        echo "}"
+    } > $f
+done
+
+{
+    echo '#include "bench_types.h"'
+    for ((u=0; u<units; u++)) ; do
+        n=$(printf "%03d" $u)
+        echo "void benchUnit$n(std::string&, char*, int, long, unsigned, double, float,"
+        echo "    const char*, const std::string&, char, bool, void*, long long, Point, bench::Money);"
+    done
+    echo
+    echo "int main(int argc, char* argv[])"
+    echo "{"
+    echo "    if (argc < 2) return 0;  // Only link, don't run"
+    echo "    std::string str, ss(\"string\");"
+    echo "    char buf[256];"
+    echo "    Point pt = {1, 2};"
+    echo "    bench::Money money = {1234};"
+    for ((u=0; u<units; u++)) ; do
+        n=$(printf "%03d" $u)
+        echo "    benchUnit$n(str, buf, 1, 2L, 3u, 4.5, 5.5f, \"cstr\", ss, 'c', true, buf, 6LL, pt, money);"
+    done
+    echo "    return 0;"
+    echo "}"
+} > $workdir/main.cpp
+
+
+#------------------------------------------------------------------------------
+# Build and measure
+
+# Run a command, printing its wall time in seconds
+timeCommand()
+{
+    local TIMEFORMAT=%R
+    { time "$@" > /dev/null 2>> $workdir/build.log ; } 2>&1
+}
+
+fileSize()
+{
+    wc -c < "$1" | tr -d ' '
+}
+
+# Count defined symbols of the object file matching a pattern
+countSymbols()
+{
+    nm -C --defined-only "$1" 2> /dev/null | grep -c "$2"
+}
+
+cxx=("$@")
+compiler=$("$1" --version 2> /dev/null | head -n 1)
+
+{
+    echo "{"
+    echo "  \"compiler\": \"${compiler//\"/\\\"}\","
+    echo "  \"flags\": \"${*:2}\","
+    echo "  \"units\": $units,"
+    echo "  \"calls_per_unit\": $calls,"
+    echo "  \"modes\": ["
+} > $output
+
+firstMode=1
+for mode in $modes ; do
+    case $mode in
+        cxx98) modeFlags="-std=c++98 -DTINYFORMAT_NO_VARIADIC_TEMPLATES" ;;
+        cxx11) modeFlags="-std=c++11 -DTINYFORMAT_USE_VARIADIC_TEMPLATES" ;;
+        cxx20) modeFlags="-std=c++20" ;;
+        cxx20_module) modeFlags="-std=c++20 -DBENCH_USE_MODULE" ;;
+        *) echo "unknown mode $mode" 1>&2 ; exit 1 ;;
+    esac
+    echo "building mode $mode..." 1>&2
+    # Build the module interface once; its time is reported separately and
+    # its object linked in with the units
+    moduleObj=""
+    if [ $mode = cxx20_module ] ; then
+        moduleObj=$workdir/tinyformat_module.o
+        case $compiler in
+            *clang*)
+                pcm=$workdir/tinyformat.pcm
+                moduleTime=$(timeCommand "${cxx[@]}" -std=c++20 -I"$srcdir" --precompile \
+                             -x c++-module "$srcdir/tinyformat.cppm" -o $pcm)
+                [ -f $pcm ] && "${cxx[@]}" -c $pcm -o $moduleObj 2>> $workdir/build.log
+                modeFlags="$modeFlags -fmodule-file=tinyformat=$pcm"
+                ;;
+            *)
+                # Keep the compiled interface in the work directory rather
+                # than g++'s default of gcm.cache/
+                echo "tinyformat $workdir/tinyformat.gcm" > $workdir/module.map
+                modeFlags="$modeFlags -fmodules-ts -fmodule-mapper=$workdir/module.map"
+                moduleTime=$(timeCommand "${cxx[@]}" $modeFlags -I"$srcdir" \
+                             -x c++ "$srcdir/tinyformat.cppm" -c -o $moduleObj)
+                ;;
+        esac
+        if [ ! -f $moduleObj ] ; then
+            echo "module build failed, see $workdir/build.log" 1>&2
+            exit 1
+        fi
+    fi
+    totalTime=0
+    maxTime=0
+    totalSize=0
+    totalFormatValue=0
+    totalFormatArg=0
+    unitJson=""
+    for ((u=0; u<units; u++)) ; do
+        n=$(printf "%03d" $u)
+        obj=$workdir/unit_${n}_$mode.o
+        t=$(timeCommand "${cxx[@]}" $modeFlags -I"$srcdir" -c $workdir/unit_$n.cpp -o $obj)
+        if [ ! -f $obj ] ; then
+            echo "compile failed, see $workdir/build.log" 1>&2
+            exit 1
+        fi
+        size=$(fileSize $obj)
+        # Count instantiations in an unoptimized build, where they aren't
+        # hidden by inlining
+        "${cxx[@]}" $modeFlags -O0 -I"$srcdir" -c $workdir/unit_$n.cpp -o $workdir/count.o
+        nFormatValue=$(countSymbols $workdir/count.o 'tinyformat::formatValue<')
+        nFormatArg=$(countSymbols $workdir/count.o 'tinyformat::detail::FormatArg::.*<')
+        totalTime=$(awk "BEGIN { print $totalTime + $t }")
+        maxTime=$(awk "BEGIN { print ($t > $maxTime) ? $t : $maxTime }")
+        totalSize=$((totalSize + size))
+        totalFormatValue=$((totalFormatValue + nFormatValue))
+        totalFormatArg=$((totalFormatArg + nFormatArg))
+        [ -n "$unitJson" ] && unitJson="$unitJson,"$'\n'
+        unitJson="$unitJson        {\"name\": \"unit_$n\", \"compile_seconds\": $t, \"object_bytes\": $size, \"formatValue_instantiations\": $nFormatValue, \"FormatArg_instantiations\": $nFormatArg}"
+    done
+    mainObj=$workdir/main_$mode.o
+    exe=$workdir/bench_$mode
+    timeCommand "${cxx[@]}" $modeFlags -I"$srcdir" -c $workdir/main.cpp -o $mainObj > /dev/null
+    linkTime=$(timeCommand "${cxx[@]}" $workdir/unit_???_$mode.o $mainObj $moduleObj -o $exe)
+    if [ ! -f $exe ] ; then
+        echo "link failed, see $workdir/build.log" 1>&2
+        exit 1
+    fi
+    exeSize=$(fileSize $exe)
+    {
+        [ $firstMode -eq 0 ] && echo "    },"
+        echo "    {"
+        echo "      \"mode\": \"$mode\","
+        [ -n "$moduleObj" ] && echo "      \"module_seconds\": $moduleTime,"
+        echo "      \"compile_seconds_total\": $totalTime,"
+        echo "      \"compile_seconds_max\": $maxTime,"
+        echo "      \"object_bytes_total\": $totalSize,"
+        echo "      \"formatValue_instantiations\": $totalFormatValue,"
+        echo "      \"FormatArg_instantiations\": $totalFormatArg,"
+        echo "      \"link_seconds\": $linkTime,"
+        echo "      \"executable_bytes\": $exeSize,"
+        echo "      \"translation_units\": ["
+        echo "$unitJson"
+        echo "      ]"
+    } >> $output
+    firstMode=0
+done
+
+{
+    echo "    }"
+    echo "  ]"
+    echo "}"
+} >> $output
+
+echo "results written to $output" 1>&2
@@ -0,0 +1,125 @@
+// tinyformat.cppm
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// C++20 module interface for tinyformat.h
+//
+// Translation units which `import tinyformat;` get the public API of
+// tinyformat.h without parsing the header and the standard headers it
+// includes each time:
+//
+//   import tinyformat;
+//
+//   int main()
+//   {
+//       tfm::printfln("%s has %d items", name, count);
+//   }
+//
+// The module is built once from this file with the header included in the
+// global module fragment, so the TINYFORMAT_* configuration macros must be
+// given on the command line when building the module, and are not visible
+// to importers.  Everything outside tinyformat::detail is exported, as is
+// the tfm namespace alias; tinyformat_module_test.cpp imports the module to
+// check this.  User defined types are formatted with operator<< or
+// tinyformatTo() found by argument dependent lookup as usual.
+//
+// Re-exporting declarations from the global module fragment needs g++ 14,
+// clang++ 16 or MSVC 17.4 or later.  g++ 12 compiles this file, but exports
+// nothing usable from it, so the CMake and make builds only build the
+// module with supported compilers.
+//
+// FdSink from tinyformat_fd.h is exported too.  The other companion headers
+// (tinyformat_catalog.h and so on) are not part of the module.
+
+module;
+
+#include "tinyformat.h"
+#include "tinyformat_fd.h"
+
+export module tinyformat;
+
+export namespace tinyformat {
+    // Formatting functions
+    using tinyformat::format;
+    using tinyformat::formatTo;
+    using tinyformat::formattedSize;
+    using tinyformat::vformat;
+    using tinyformat::vformatTo;
+    using tinyformat::vformattedSize;
+#ifdef TINYFORMAT_OSTREAM_INCLUDED
+    using tinyformat::printf;
+    using tinyformat::printfln;
+    using tinyformat::formatValue;
+#endif
+
+    // Argument lists
+    using tinyformat::FormatList;
+    using tinyformat::FormatListRef;
+    using tinyformat::DynamicFormatList;
+    using tinyformat::makeFormatList;
+
+    // Sinks
+    using tinyformat::Sink;
+    using tinyformat::BasicStringSink;
+    using tinyformat::StringSink;
+    using tinyformat::FixedBufferSink;
+    using tinyformat::TeeSink;
+    using tinyformat::ChunkedFormatter;
+#ifdef TINYFORMAT_HAS_FD_SINK
+    using tinyformat::FdSink;
+#endif
+#ifdef TINYFORMAT_OSTREAM_INCLUDED
+    using tinyformat::OstreamSink;
+    using tinyformat::BufferedOstreamSink;
+#endif
+
+    // Argument wrappers and user defined formatting
+    using tinyformat::FormatSpec;
+    using tinyformat::tinyformatTo;
+    using tinyformat::HexBytes;
+    using tinyformat::hexbytes;
+    using tinyformat::Range;
+    using tinyformat::range;
+#ifdef TINYFORMAT_HAS_LAZY
+    using tinyformat::Lazy;
+    using tinyformat::lazy;
+#endif
+#ifdef TINYFORMAT_HAS_CHRONO
+    using tinyformat::Timestamp;
+    using tinyformat::timestamp;
+#endif
+
+    // Capacity hints for string results
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+    using tinyformat::CapacityHintStats;
+    using tinyformat::capacityHintStats;
+    using tinyformat::capacityHint;
+    using tinyformat::resetCapacityHints;
+#endif
+}
+
+export namespace tfm = tinyformat;
@@ -80,6 +80,13 @@
 // convenience function printfln() which appends a newline to the usual result
 // of printf() for super simple logging.
 //
+// For latency critical code, formatTo() formats into a caller provided buffer
+// with the semantics of snprintf(), and is guaranteed not to allocate when
+// formatting built-in types:
+//
+//   char buf[64];
+//   tfm::formatTo(buf, sizeof(buf), "%s %d", month, day);
+//
 //
 // User defined format functions
 // -----------------------------
@@ -118,7 +125,9 @@
 // specifiers (calls assert() by default).
 //
 // User defined types: Uses operator<< for user defined types by default.
-// Overload formatValue() for more control.
+// Overload formatValue() for more control, or define
+// tinyformatTo(Sink&, const FormatSpec&, const T&) in the namespace of T to
+// write to the output directly without going through a stream.
 
 
 #ifndef TINYFORMAT_H_INCLUDED
@@ -138,13 +147,52 @@ namespace tfm = tinyformat;
 // general.  If you don't define this, C++11 support is autodetected below.
 // #define TINYFORMAT_USE_VARIADIC_TEMPLATES
 
+// Define to always format built-in numeric types as in the "C" locale,
+// ignoring any locale imbued on the output stream.  By default tinyformat
+// formats numbers natively (bypassing the std::num_put and std::numpunct
+// facets) only when the stream has the classic locale.
+// #define TINYFORMAT_USE_C_LOCALE
+
+// Define to build without the iostreams library.  Built-in types are then
+// formatted as in the "C" locale into sinks, strings and buffers, and only
+// lightweight standard headers are included.  Formatting of user defined
+// types via operator<<, and the std::ostream based API including printf(),
+// are unavailable; include "tinyformat_ostream.h" to opt back into the
+// std::ostream output functions.  Like TINYFORMAT_USE_C_LOCALE, this must be
+// defined consistently in all translation units of a program.
+// #define TINYFORMAT_NO_IOSTREAM
+
+// Define to add a format() overload taking a std::pmr::memory_resource* and
+// returning a std::pmr::string, in C++17.  It's off by default because
+// <memory_resource> is slow to compile; without it, the std::allocator_arg
+// overload of format() accepts a std::pmr::polymorphic_allocator.
+// #define TINYFORMAT_USE_PMR
+
+// Define to make the string returning format() functions remember the
+// largest output produced for each format string (keyed by its address) in
+// a small fixed size table, and reserve that much space up front on later
+// calls.  This avoids growing the result several times at call sites where
+// the output is longer than estimated from the arguments, for example with
+// long C strings or user defined types.  The table is lock-free, holds
+// TINYFORMAT_CAPACITY_HINT_SLOTS entries (256 by default, a power of two)
+// and can be inspected with capacityHintStats().  Needs C++11, and must be
+// defined consistently in all translation units of a program.
+// #define TINYFORMAT_USE_CAPACITY_HINTS
+
 
 //------------------------------------------------------------------------------
 // Implementation details.
 #include <algorithm>
-#include <iostream>
-#include <sstream>
-#include <cmath>
+#include <iosfwd>
+#ifndef TINYFORMAT_NO_IOSTREAM
+#   include <cmath>
+#   include <iostream>
+#   include <sstream>
+#endif
+#include <cstring>
+#include <stdio.h>
+#include <new>
+#include <string>
 
 #ifndef TINYFORMAT_ASSERT
 #   include <cassert>
@@ -161,6 +209,10 @@ namespace tfm = tinyformat;
 #       define TINYFORMAT_USE_VARIADIC_TEMPLATES
 #   endif
 #endif
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+// For std::allocator_arg
+#   include <memory>
+#endif
 
 #if defined(__GLIBCXX__) && __GLIBCXX__ < 20080201
 //  std::showpos is broken on old libstdc++ as provided with macOS.  See
@@ -168,6 +220,66 @@ namespace tfm = tinyformat;
 #   define TINYFORMAT_OLD_LIBSTDCPLUSPLUS_WORKAROUND
 #endif
 
+// Detect C++17 polymorphic memory resources when asked to, for formatting
+// directly into std::pmr::string.
+#if defined(TINYFORMAT_USE_PMR) && !defined(TINYFORMAT_HAS_PMR) && \
+    defined(TINYFORMAT_USE_VARIADIC_TEMPLATES) && defined(__has_include)
+#   if __has_include(<memory_resource>) && \
+       (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#       define TINYFORMAT_HAS_PMR
+#   endif
+#endif
+#ifdef TINYFORMAT_HAS_PMR
+#   include <memory_resource>
+#endif
+
+// Detect C++11 <chrono> and thread_local, for formatting timestamps and for
+// time limits on buffered output.  These and lazy arguments aren't detected
+// with TINYFORMAT_NO_IOSTREAM, to keep the included headers to a minimum;
+// define TINYFORMAT_HAS_CHRONO or TINYFORMAT_HAS_LAZY to enable them.
+#if !defined(TINYFORMAT_HAS_CHRONO) && !defined(TINYFORMAT_NO_IOSTREAM) && \
+    (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#   define TINYFORMAT_HAS_CHRONO
+#endif
+#ifdef TINYFORMAT_HAS_CHRONO
+#   include <chrono>
+#   include <ctime>
+#endif
+
+// Detect C++11 decltype and std::decay, for lazily evaluated arguments
+#if !defined(TINYFORMAT_HAS_LAZY) && !defined(TINYFORMAT_NO_IOSTREAM) && \
+    (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#   define TINYFORMAT_HAS_LAZY
+#endif
+#ifdef TINYFORMAT_HAS_LAZY
+#   include <type_traits>
+#   include <utility>
+#endif
+
+// Capacity hints for string results need C++11 atomics
+#if defined(TINYFORMAT_USE_CAPACITY_HINTS) && !defined(TINYFORMAT_HAS_CAPACITY_HINTS) && \
+    (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1900))
+#   define TINYFORMAT_HAS_CAPACITY_HINTS
+#endif
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+#   include <atomic>
+#   include <cstdint>
+#   ifndef TINYFORMAT_CAPACITY_HINT_SLOTS
+#       define TINYFORMAT_CAPACITY_HINT_SLOTS 256
+#   endif
+// Hints are capped so that one unusually long result doesn't make every
+// later call at the same site reserve that much
+#   ifndef TINYFORMAT_CAPACITY_HINT_MAX
+#       define TINYFORMAT_CAPACITY_HINT_MAX 65536
+#   endif
+#endif
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#   define TINYFORMAT_SNPRINTF _snprintf
+#else
+#   define TINYFORMAT_SNPRINTF snprintf
+#endif
+
 #ifdef __APPLE__
 // Workaround macOS linker warning: Xcode uses different default symbol
 // visibilities for static libs vs executables (see issue #25)
@@ -178,6 +290,320 @@ namespace tfm = tinyformat;
 
 namespace tinyformat {
 
+//------------------------------------------------------------------------------
+// Output sinks
+
+/// Lightweight output target for the formatting engine.
+///
+/// A sink may provide a window of writable memory into which append(),
+/// fill() and put() copy output directly, without any virtual calls.  Only
+/// output which doesn't fit in the window is passed to the virtual overflow()
+/// function, which consumes it and may set up a new window.  A sink without
+/// a window receives all output via overflow().
+///
+/// To format to a new kind of target, derive from Sink and implement
+/// overflow().
+class Sink
+{
+    public:
+        virtual ~Sink() { }
+
+        /// Append the `n` characters at `s`
+        void append(const char* s, std::size_t n)
+        {
+            if (n <= available()) {
+                if (n != 0)
+                    std::memcpy(m_pos, s, n);
+                m_pos += n;
+            }
+            else {
+                overflow(s, n);
+            }
+        }
+
+        /// Append `n` copies of the character `c`
+        void fill(char c, std::size_t n)
+        {
+            if (n <= available()) {
+                if (n != 0)
+                    std::memset(m_pos, c, n);
+                m_pos += n;
+            }
+            else {
+                overflowFill(c, n);
+            }
+        }
+
+        /// Append the single character `c`
+        void put(char c)
+        {
+            if (m_pos != m_end)
+                *m_pos++ = c;
+            else
+                overflow(&c, 1);
+        }
+
+        /// Hint that at least `n` more characters are about to be appended
+        void reserve(std::size_t n)
+        {
+            if (n > available())
+                grow(n);
+        }
+
+        /// Return the stream underlying this sink, if any.
+        ///
+        /// User defined types are formatted with formatValue() directly into
+        /// this stream, and built-in numeric types are formatted according
+        /// to its locale.  Sinks which buffer output must write it to the
+        /// stream before returning it.  For sinks without a stream, a
+        /// temporary stream writing to the sink is used for user defined
+        /// types, and numbers are formatted as for a newly constructed
+        /// stream.
+        virtual std::ostream* ostream() { return 0; }
+
+        /// Return the stream whose locale built-in numeric types are
+        /// formatted according to, without writing any buffered output to
+        /// it.  By default this is ostream(); buffering sinks override it to
+        /// avoid a flush for each formatting call.  When ostream() returns
+        /// null, user defined types are formatted via a temporary stream
+        /// with the locale and format flags of this stream.
+        virtual const std::ostream* localeStream() { return ostream(); }
+
+    protected:
+        Sink() : m_pos(0), m_end(0) { }
+
+        /// Set the window of memory [pos, end) for output to be written to
+        void setWindow(char* pos, char* end) { m_pos = pos; m_end = end; }
+
+        /// Return the current position in the window
+        char* windowPos() const { return m_pos; }
+
+        /// Consume `n` characters at `s` which don't fit in the window
+        virtual void overflow(const char* s, std::size_t n) = 0;
+
+        /// Consume `n` fill characters `c` which don't fit in the window.
+        /// By default they're passed to overflow() in chunks.
+        virtual void overflowFill(char c, std::size_t n)
+        {
+            char buf[64];
+            std::memset(buf, c, (std::min)(n, sizeof(buf)));
+            while (n > 0) {
+                std::size_t nwrite = (std::min)(n, sizeof(buf));
+                append(buf, nwrite);
+                n -= nwrite;
+            }
+        }
+
+        /// Make room for at least `n` characters if possible, as requested by
+        /// reserve().  Does nothing by default.
+        virtual void grow(std::size_t /*n*/) { }
+
+    private:
+        Sink(const Sink&);
+        Sink& operator=(const Sink&);
+
+        std::size_t available() const { return static_cast<std::size_t>(m_end - m_pos); }
+
+        char* m_pos;
+        char* m_end;
+};
+
+
+/// Sink appending to a std::basic_string.
+///
+/// Output is collected in a small buffer inside the sink and appended to the
+/// string when the buffer fills up, so the string never holds anything but
+/// the output and may itself be one of the arguments being formatted.
+/// Pointers into the string, such as its c_str(), can't be arguments, since
+/// appending the output may invalidate them.  Call finish() (or destroy the
+/// sink) to append the last of the output before using the string.
+template<typename StringT>
+class BasicStringSink : public Sink
+{
+    public:
+        explicit BasicStringSink(StringT& str) : m_str(str)
+        {
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        ~BasicStringSink() { finish(); }
+
+        /// Append any buffered output to the string
+        void finish()
+        {
+            flushBuffer();
+        }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            // `s` may point into the string's storage (when formatting a
+            // string into itself), which appending the buffer can
+            // reallocate, so remember where it was.
+            const char* data = m_str.data();
+            bool inString = s >= data && s < data + m_str.size();
+            std::size_t offset = inString ? static_cast<std::size_t>(s - data) : 0;
+            flushBuffer();
+            if (n < sizeof(m_buf)) {
+                std::memcpy(m_buf, inString ? m_str.data() + offset : s, n);
+                setWindow(m_buf + n, m_buf + sizeof(m_buf));
+            }
+            else if (inString) {
+                m_str.append(m_str, offset, n);
+            }
+            else {
+                m_str.append(s, n);
+            }
+        }
+
+        virtual void overflowFill(char c, std::size_t n)
+        {
+            flushBuffer();
+            m_str.append(n, c);
+        }
+
+    private:
+        std::size_t bufferedLength() const
+        {
+            return static_cast<std::size_t>(windowPos() - m_buf);
+        }
+
+        void flushBuffer()
+        {
+            std::size_t len = bufferedLength();
+            if (len != 0)
+                m_str.append(m_buf, len);
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        StringT& m_str;
+        char m_buf[256];
+};
+
+typedef BasicStringSink<std::string> StringSink;
+
+
+/// Sink writing to a fixed size character buffer, with the semantics of C99
+/// snprintf(): output which doesn't fit is discarded but counted, and space
+/// is always left for a terminating NUL.
+class FixedBufferSink : public Sink
+{
+    public:
+        FixedBufferSink(char* buf, std::size_t bufSize)
+            : m_buf(buf), m_bufSize(bufSize), m_discarded(0)
+        {
+            if (bufSize > 0)
+                setWindow(buf, buf + bufSize - 1);
+        }
+
+        /// NUL terminate the buffer and return the number of characters
+        /// which would have been written given sufficient space.
+        std::size_t finish()
+        {
+            if (m_bufSize == 0)
+                return m_discarded;
+            *windowPos() = '\0';
+            return static_cast<std::size_t>(windowPos() - m_buf) + m_discarded;
+        }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            std::size_t nwrite = m_bufSize == 0 ? 0 :
+                static_cast<std::size_t>(m_buf + m_bufSize - 1 - windowPos());
+            append(s, nwrite);
+            m_discarded += n - nwrite;
+        }
+
+        virtual void overflowFill(char c, std::size_t n)
+        {
+            std::size_t nwrite = m_bufSize == 0 ? 0 :
+                static_cast<std::size_t>(m_buf + m_bufSize - 1 - windowPos());
+            fill(c, nwrite);
+            m_discarded += n - nwrite;
+        }
+
+    private:
+        char* m_buf;
+        std::size_t m_bufSize;
+        std::size_t m_discarded;
+};
+
+
+/// Sink forwarding the same output to several other sinks.
+///
+/// Output is rendered once into a scratch buffer, and the buffer copied to
+/// each target sink when it fills, on flush() or on destruction, so the
+/// formatting cost doesn't depend on the number of targets.
+///
+///   tfm::TeeSink tee(fileSink, ringSink);
+///   tfm::format(tee, "%s: %d\n", name, value);
+///
+/// As for other sinks without a stream, user defined types are formatted
+/// via a temporary stream, and numbers as for a newly constructed stream.
+class TeeSink : public Sink
+{
+    public:
+        TeeSink(Sink& sink1, Sink& sink2)
+            : m_sinks(m_ownSinks), m_numSinks(2)
+        {
+            m_ownSinks[0] = &sink1;
+            m_ownSinks[1] = &sink2;
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        TeeSink(Sink& sink1, Sink& sink2, Sink& sink3)
+            : m_sinks(m_ownSinks), m_numSinks(3)
+        {
+            m_ownSinks[0] = &sink1;
+            m_ownSinks[1] = &sink2;
+            m_ownSinks[2] = &sink3;
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        /// Forward to the `numSinks` sinks pointed to by `sinks`, which must
+        /// outlive the TeeSink.
+        TeeSink(Sink* const* sinks, std::size_t numSinks)
+            : m_sinks(sinks), m_numSinks(numSinks)
+        {
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        ~TeeSink() { flush(); }
+
+        /// Copy any buffered output to the target sinks
+        void flush()
+        {
+            forward(m_buf, static_cast<std::size_t>(windowPos() - m_buf));
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            flush();
+            if (n < sizeof(m_buf))
+                append(s, n);
+            else
+                forward(s, n);
+        }
+
+    private:
+        void forward(const char* s, std::size_t n)
+        {
+            if (n == 0)
+                return;
+            for (std::size_t i = 0; i < m_numSinks; ++i)
+                m_sinks[i]->append(s, n);
+        }
+
+        Sink* m_ownSinks[3];
+        Sink* const* m_sinks;
+        std::size_t m_numSinks;
+        char m_buf[512];
+};
+
+
 //------------------------------------------------------------------------------
 namespace detail {
 
@@ -220,6 +646,7 @@ template<int n> struct is_wchar<const wchar_t[n]> {};
 template<int n> struct is_wchar<wchar_t[n]> {};
 
 
+#ifndef TINYFORMAT_NO_IOSTREAM
 // Format the value by casting to type fmtT.  This default implementation
 // should never be called.
 template<typename T, typename fmtT, bool convertible = is_convertible<T, fmtT>::value>
@@ -255,6 +682,7 @@ struct formatZeroIntegerWorkaround<T,true>
     }
 };
 #endif // TINYFORMAT_OLD_LIBSTDCPLUSPLUS_WORKAROUND
+#endif // TINYFORMAT_NO_IOSTREAM
 
 // Convert an arbitrary type to integer.  The version with convertible=false
 // throws an error.
@@ -275,14 +703,126 @@ struct convertToInt<T,true>
     static int invoke(const T& value) { return static_cast<int>(value); }
 };
 
+#ifndef TINYFORMAT_NO_IOSTREAM
+// Stream buffer which forwards at most a fixed number of characters to
+// another stream and silently discards the rest.
+class TruncatingStreambuf : public std::streambuf
+{
+    public:
+        TruncatingStreambuf(std::ostream& out, int ntrunc)
+            : m_out(out), m_remaining(ntrunc) { }
+
+    protected:
+        virtual std::streamsize xsputn(const char* s, std::streamsize n)
+        {
+            std::streamsize nwrite = (std::min)(n, m_remaining);
+            if (nwrite > 0) {
+                m_out.write(s, nwrite);
+                m_remaining -= nwrite;
+            }
+            return m_out ? n : 0;
+        }
+
+        virtual int_type overflow(int_type c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            char ch = traits_type::to_char_type(c);
+            return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+        }
+
+    private:
+        std::ostream& m_out;
+        std::streamsize m_remaining;
+};
+
+// Stream buffer which forwards to another stream, replacing '+' with ' '.
+// Used to simulate the "% d" flag which has no direct iostreams equivalent.
+class SpacePadStreambuf : public std::streambuf
+{
+    public:
+        SpacePadStreambuf(std::ostream& out) : m_out(out) { }
+
+    protected:
+        virtual std::streamsize xsputn(const char* s, std::streamsize n)
+        {
+            const char* runStart = s;
+            const char* end = s + n;
+            for (const char* c = s; c != end; ++c) {
+                if (*c == '+') {
+                    m_out.write(runStart, c - runStart);
+                    m_out.put(' ');
+                    runStart = c + 1;
+                }
+            }
+            m_out.write(runStart, end - runStart);
+            return m_out ? n : 0;
+        }
+
+        virtual int_type overflow(int_type c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            char ch = traits_type::to_char_type(c);
+            return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+        }
+
+    private:
+        std::ostream& m_out;
+};
+
+// Stream buffer writing to a Sink, for formatting user defined types into
+// sinks which don't have an underlying stream.
+class SinkStreambuf : public std::streambuf
+{
+    public:
+        SinkStreambuf(Sink& sink) : m_sink(sink) { }
+
+    protected:
+        virtual std::streamsize xsputn(const char* s, std::streamsize n)
+        {
+            m_sink.append(s, static_cast<std::size_t>(n));
+            return n;
+        }
+
+        virtual int_type overflow(int_type c)
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+                m_sink.put(traits_type::to_char_type(c));
+            return traits_type::not_eof(c);
+        }
+
+    private:
+        Sink& m_sink;
+};
+#endif // TINYFORMAT_NO_IOSTREAM
+
+// Sink which discards its output, counting the characters written
+class CountingSink : public Sink
+{
+    public:
+        CountingSink() : m_count(0) { }
+
+        std::size_t count() const { return m_count; }
+
+    protected:
+        virtual void overflow(const char* /*s*/, std::size_t n) { m_count += n; }
+        virtual void overflowFill(char /*c*/, std::size_t n) { m_count += n; }
+
+    private:
+        std::size_t m_count;
+};
+
+#ifndef TINYFORMAT_NO_IOSTREAM
 // Format at most ntrunc characters to the given stream.
 template<typename T>
 inline void formatTruncated(std::ostream& out, const T& value, int ntrunc)
 {
-    std::ostringstream tmp;
+    // Format via a truncating stream buffer rather than a temporary string
+    // so that truncating conversions don't allocate.
+    TruncatingStreambuf truncBuf(out, ntrunc);
+    std::ostream tmp(&truncBuf);
     tmp << value;
-    std::string result = tmp.str();
-    out.write(result.c_str(), (std::min)(ntrunc, static_cast<int>(result.size())));
 }
 #define TINYFORMAT_DEFINE_FORMAT_TRUNCATED_CSTR(type)       \
 inline void formatTruncated(std::ostream& out, type* value, int ntrunc) \
@@ -312,10 +852,12 @@ TINYFORMAT_SETFILL_NOT_FINITE_FLOATING(float)
 TINYFORMAT_SETFILL_NOT_FINITE_FLOATING(double)
 TINYFORMAT_SETFILL_NOT_FINITE_FLOATING(long double)
 #undef TINYFORMAT_SETFILL_NOT_FINITE_FLOATING
+#endif // TINYFORMAT_NO_IOSTREAM
 
 } // namespace detail
 
 
+#ifndef TINYFORMAT_NO_IOSTREAM
 //------------------------------------------------------------------------------
 // Variable formatting functions.  May be overridden for user-defined types if
 // desired.
@@ -384,6 +926,7 @@ TINYFORMAT_DEFINE_FORMATVALUE_CHAR(char)
 TINYFORMAT_DEFINE_FORMATVALUE_CHAR(signed char)
 TINYFORMAT_DEFINE_FORMATVALUE_CHAR(unsigned char)
 #undef TINYFORMAT_DEFINE_FORMATVALUE_CHAR
+#endif // TINYFORMAT_NO_IOSTREAM
 
 
 //------------------------------------------------------------------------------
@@ -393,6 +936,7 @@ TINYFORMAT_DEFINE_FORMATVALUE_CHAR(unsigned char)
 
 #define TINYFORMAT_ARGTYPES(n) TINYFORMAT_ARGTYPES_ ## n
 #define TINYFORMAT_VARARGS(n) TINYFORMAT_VARARGS_ ## n
+#define TINYFORMAT_REFARGS(n) TINYFORMAT_REFARGS_ ## n
 #define TINYFORMAT_PASSARGS(n) TINYFORMAT_PASSARGS_ ## n
 #define TINYFORMAT_PASSARGS_TAIL(n) TINYFORMAT_PASSARGS_TAIL_ ## n
 
@@ -420,6 +964,10 @@ cog.outl()
 makeCommaSepLists('#define TINYFORMAT_VARARGS_%(j)d %(list)s',
                   'const T%(i)d& v%(i)d')
 
+cog.outl()
+makeCommaSepLists('#define TINYFORMAT_REFARGS_%(j)d %(list)s',
+                  'T%(i)d& v%(i)d')
+
 cog.outl()
 makeCommaSepLists('#define TINYFORMAT_PASSARGS_%(j)d %(list)s', 'v%(i)d')
 
@@ -466,6 +1014,23 @@ cog.outl('#define TINYFORMAT_FOREACH_ARGNUM(m) \\\n    ' +
 #define TINYFORMAT_VARARGS_15 const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7, const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15
 #define TINYFORMAT_VARARGS_16 const T1& v1, const T2& v2, const T3& v3, const T4& v4, const T5& v5, const T6& v6, const T7& v7, const T8& v8, const T9& v9, const T10& v10, const T11& v11, const T12& v12, const T13& v13, const T14& v14, const T15& v15, const T16& v16
 
+#define TINYFORMAT_REFARGS_1 T1& v1
+#define TINYFORMAT_REFARGS_2 T1& v1, T2& v2
+#define TINYFORMAT_REFARGS_3 T1& v1, T2& v2, T3& v3
+#define TINYFORMAT_REFARGS_4 T1& v1, T2& v2, T3& v3, T4& v4
+#define TINYFORMAT_REFARGS_5 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5
+#define TINYFORMAT_REFARGS_6 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6
+#define TINYFORMAT_REFARGS_7 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7
+#define TINYFORMAT_REFARGS_8 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8
+#define TINYFORMAT_REFARGS_9 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9
+#define TINYFORMAT_REFARGS_10 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10
+#define TINYFORMAT_REFARGS_11 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11
+#define TINYFORMAT_REFARGS_12 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11, T12& v12
+#define TINYFORMAT_REFARGS_13 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11, T12& v12, T13& v13
+#define TINYFORMAT_REFARGS_14 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11, T12& v12, T13& v13, T14& v14
+#define TINYFORMAT_REFARGS_15 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11, T12& v12, T13& v13, T14& v14, T15& v15
+#define TINYFORMAT_REFARGS_16 T1& v1, T2& v2, T3& v3, T4& v4, T5& v5, T6& v6, T7& v7, T8& v8, T9& v9, T10& v10, T11& v11, T12& v12, T13& v13, T14& v14, T15& v15, T16& v16
+
 #define TINYFORMAT_PASSARGS_1 v1
 #define TINYFORMAT_PASSARGS_2 v1, v2
 #define TINYFORMAT_PASSARGS_3 v1, v2, v3
@@ -506,8 +1071,170 @@ cog.outl('#define TINYFORMAT_FOREACH_ARGNUM(m) \\\n    ' +
 
 
 
+namespace detail { struct FormatSpec; }
+
+/// Parsed conversion specification, as passed to user defined tinyformatTo()
+/// functions.  See detail::FormatSpec for the fields.
+typedef detail::FormatSpec FormatSpec;
+
+
+/// Range of bytes to be formatted as hex, as returned by hexbytes()
+struct HexBytes
+{
+    const unsigned char* data;
+    std::size_t size;
+    // Number of bytes between separators, or zero for no separators
+    std::size_t groupSize;
+    char separator;
+};
+
+/// Wrap the `size` bytes at `data` for formatting as pairs of hex digits,
+/// for example
+///
+///   tfm::format("%s", tfm::hexbytes(packet, len, 4)) // "0a1b2c3d 4e5f..."
+///
+/// If groupSize is nonzero, `separator` is inserted after every groupSize
+/// bytes.  Any precision limits the number of bytes shown ("%.16s") and
+/// "%X" gives upper case digits.
+inline HexBytes hexbytes(const void* data, std::size_t size,
+                         std::size_t groupSize = 0, char separator = ' ')
+{
+    HexBytes bytes = {static_cast<const unsigned char*>(data), size,
+                      groupSize, separator};
+    return bytes;
+}
+
+template<typename Iter> class Range;
+#ifdef TINYFORMAT_HAS_LAZY
+template<typename F> class Lazy;
+#endif
+
+
 namespace detail {
 
+// Classification of argument types which can be formatted natively, without
+// going through formatValue() and the stream.
+enum ArgType
+{
+    ArgOther,
+    ArgSinkFormat,  // User defined type with a tinyformatTo() function
+    ArgBool,
+    ArgChar,
+    ArgSignedChar,
+    ArgUnsignedChar,
+    ArgShort,
+    ArgUnsignedShort,
+    ArgInt,
+    ArgUnsignedInt,
+    ArgLong,
+    ArgUnsignedLong,
+    ArgLongLong,
+    ArgUnsignedLongLong,
+    ArgFloat,
+    ArgDouble,
+    ArgLongDouble,
+    ArgPointer,
+    ArgCString,
+    ArgCharArray,
+    ArgStdString,
+    ArgHexBytes,
+    ArgRange,       // Range, with the conversion applied to each element
+    ArgLazy         // Lazy, formatted as the result of its callable
+};
+
+template<typename T> struct ArgTypeOf { static const ArgType value = ArgOther; };
+#define TINYFORMAT_DEFINE_ARGTYPE(type, argType) \
+template<> struct ArgTypeOf<type> { static const ArgType value = argType; };
+TINYFORMAT_DEFINE_ARGTYPE(bool, ArgBool)
+TINYFORMAT_DEFINE_ARGTYPE(char, ArgChar)
+TINYFORMAT_DEFINE_ARGTYPE(signed char, ArgSignedChar)
+TINYFORMAT_DEFINE_ARGTYPE(unsigned char, ArgUnsignedChar)
+TINYFORMAT_DEFINE_ARGTYPE(short, ArgShort)
+TINYFORMAT_DEFINE_ARGTYPE(unsigned short, ArgUnsignedShort)
+TINYFORMAT_DEFINE_ARGTYPE(int, ArgInt)
+TINYFORMAT_DEFINE_ARGTYPE(unsigned int, ArgUnsignedInt)
+TINYFORMAT_DEFINE_ARGTYPE(long, ArgLong)
+TINYFORMAT_DEFINE_ARGTYPE(unsigned long, ArgUnsignedLong)
+TINYFORMAT_DEFINE_ARGTYPE(long long, ArgLongLong)
+TINYFORMAT_DEFINE_ARGTYPE(unsigned long long, ArgUnsignedLongLong)
+TINYFORMAT_DEFINE_ARGTYPE(float, ArgFloat)
+TINYFORMAT_DEFINE_ARGTYPE(double, ArgDouble)
+TINYFORMAT_DEFINE_ARGTYPE(long double, ArgLongDouble)
+TINYFORMAT_DEFINE_ARGTYPE(void*, ArgPointer)
+TINYFORMAT_DEFINE_ARGTYPE(const void*, ArgPointer)
+TINYFORMAT_DEFINE_ARGTYPE(char*, ArgCString)
+TINYFORMAT_DEFINE_ARGTYPE(const char*, ArgCString)
+TINYFORMAT_DEFINE_ARGTYPE(std::string, ArgStdString)
+TINYFORMAT_DEFINE_ARGTYPE(HexBytes, ArgHexBytes)
+#undef TINYFORMAT_DEFINE_ARGTYPE
+template<std::size_t n> struct ArgTypeOf<char[n]> { static const ArgType value = ArgCharArray; };
+template<std::size_t n> struct ArgTypeOf<const char[n]> { static const ArgType value = ArgCharArray; };
+template<typename Iter> struct ArgTypeOf<Range<Iter> > { static const ArgType value = ArgRange; };
+
+// Detect a user supplied function
+//
+//   void tinyformatTo(Sink& out, const FormatSpec& spec, const T& value);
+//
+// found by argument dependent lookup.  The fallback declared here is only
+// chosen when there's no better match, and is recognized by its distinct
+// return type.  (Using the comma operator copes with a void return type.)
+struct NoSinkFormat {};
+struct SinkFormatTag {};
+struct AnyArg { template<typename T> AnyArg(const T&) {} };
+NoSinkFormat tinyformatTo(Sink&, const FormatSpec&, AnyArg);
+NoSinkFormat operator,(NoSinkFormat, SinkFormatTag);
+char (&checkSinkFormat(SinkFormatTag))[1];
+char (&checkSinkFormat(NoSinkFormat))[2];
+
+template<typename T>
+struct HasSinkFormat
+{
+    static Sink& makeSink();
+    static const FormatSpec& makeSpec();
+    static const T& makeValue();
+    static const bool value = sizeof(checkSinkFormat(
+        (tinyformatTo(makeSink(), makeSpec(), makeValue()), SinkFormatTag()))) == 1;
+};
+
+template<typename T>
+struct ArgTypeOfUser
+{
+    static const ArgType value =
+        HasSinkFormat<T>::value && ArgTypeOf<T>::value == ArgOther ? ArgSinkFormat
+                                                                   : ArgTypeOf<T>::value;
+};
+
+template<bool> struct BoolTag {};
+
+#ifdef TINYFORMAT_NO_IOSTREAM
+// Without iostreams only the built-in types above and types with a
+// tinyformatTo() function can be formatted; make anything else fail at
+// compile time.
+template<ArgType type> struct RequireBuiltinArg { typedef int tinyformat_type_cannot_be_formatted_without_iostreams; };
+template<> struct RequireBuiltinArg<ArgOther> {};
+#endif
+
+
+#ifdef TINYFORMAT_HAS_LAZY
+class FormatArg;
+
+// Type-erased base of Lazy<F>, giving the argument to format in its place.
+class LazyArg
+{
+    public:
+        const FormatArg& resolve() const { return m_resolveImpl(*this); }
+
+    protected:
+        typedef const FormatArg& (*ResolveFunc)(const LazyArg& self);
+
+        explicit LazyArg(ResolveFunc resolveImpl) : m_resolveImpl(resolveImpl) { }
+
+    private:
+        ResolveFunc m_resolveImpl;
+};
+#endif
+
+
 // Type-opaque holder for an argument to format(), with associated actions on
 // the type held as explicit function pointers.  This allows FormatArg's for
 // each argument to be allocated as a homogeneous array inside FormatList
@@ -517,8 +1244,12 @@ class FormatArg
     public:
         FormatArg()
             : m_value(NULL),
+#ifndef TINYFORMAT_NO_IOSTREAM
             m_formatImpl(NULL),
-            m_toIntImpl(NULL)
+#endif
+            m_sinkFormatImpl(NULL),
+            m_toIntImpl(NULL),
+            m_type(ArgOther)
         { }
 
         template<typename T>
@@ -526,10 +1257,36 @@ class FormatArg
             // C-style cast here allows us to also remove volatile; we put it
             // back in the *Impl functions before dereferencing to avoid UB.
             : m_value((const void*)(&value)),
-            m_formatImpl(&formatImpl<T>),
-            m_toIntImpl(&toIntImpl<T>)
+#ifndef TINYFORMAT_NO_IOSTREAM
+            m_formatImpl(streamFormatter<T>(BoolTag<HasSinkFormat<T>::value>())),
+#endif
+            m_sinkFormatImpl(sinkFormatter<T>(BoolTag<HasSinkFormat<T>::value>())),
+            m_toIntImpl(&toIntImpl<T>),
+            m_type(ArgTypeOfUser<T>::value)
+        {
+#ifdef TINYFORMAT_NO_IOSTREAM
+            typedef typename RequireBuiltinArg<ArgTypeOfUser<T>::value>::
+                tinyformat_type_cannot_be_formatted_without_iostreams DummyType;
+            (void) DummyType();
+#endif
+        }
+
+#ifdef TINYFORMAT_HAS_LAZY
+        // Lazy arguments hold their LazyArg base, which evaluates the
+        // callable when the argument is first resolved.
+        template<typename F>
+        FormatArg(const Lazy<F>& value)
+            : m_value(static_cast<const LazyArg*>(&value)),
+#ifndef TINYFORMAT_NO_IOSTREAM
+            m_formatImpl(NULL),
+#endif
+            m_sinkFormatImpl(NULL),
+            m_toIntImpl(&lazyToIntImpl),
+            m_type(ArgLazy)
         { }
+#endif
 
+#ifndef TINYFORMAT_NO_IOSTREAM
         void format(std::ostream& out, const char* fmtBegin,
                     const char* fmtEnd, int ntrunc) const
         {
@@ -537,6 +1294,15 @@ class FormatArg
             TINYFORMAT_ASSERT(m_formatImpl);
             m_formatImpl(out, fmtBegin, fmtEnd, ntrunc, m_value);
         }
+#endif
+
+        // Format a user defined type with its tinyformatTo() function
+        void formatToSink(Sink& out, const FormatSpec& spec) const
+        {
+            TINYFORMAT_ASSERT(m_value);
+            TINYFORMAT_ASSERT(m_sinkFormatImpl);
+            m_sinkFormatImpl(out, spec, m_value);
+        }
 
         int toInt() const
         {
@@ -545,7 +1311,25 @@ class FormatArg
             return m_toIntImpl(m_value);
         }
 
+        // Type of the held value, for native formatting of built-in types
+        ArgType type() const { return m_type; }
+        const void* value() const { return m_value; }
+
+#ifdef TINYFORMAT_HAS_LAZY
+        // The argument to format in place of a lazy one
+        const FormatArg& resolve() const
+        {
+            TINYFORMAT_ASSERT(m_type == ArgLazy);
+            return static_cast<const LazyArg*>(m_value)->resolve();
+        }
+#endif
+
     private:
+        typedef void (*StreamFormatFunc)(std::ostream& out, const char* fmtBegin,
+                                         const char* fmtEnd, int ntrunc, const void* value);
+        typedef void (*SinkFormatFunc)(Sink& out, const FormatSpec& spec, const void* value);
+
+#ifndef TINYFORMAT_NO_IOSTREAM
         template<typename T>
         TINYFORMAT_HIDDEN static void formatImpl(std::ostream& out, const char* fmtBegin,
                         const char* fmtEnd, int ntrunc, const void* value)
@@ -553,16 +1337,46 @@ class FormatArg
             formatValue(out, fmtBegin, fmtEnd, ntrunc, *static_cast<const T*>(value));
         }
 
+        // Types with a tinyformatTo() function are never formatted via
+        // formatValue(), which may not even compile for them.
         template<typename T>
-        TINYFORMAT_HIDDEN static int toIntImpl(const void* value)
+        static StreamFormatFunc streamFormatter(BoolTag<false>) { return &formatImpl<T>; }
+        template<typename T>
+        static StreamFormatFunc streamFormatter(BoolTag<true>) { return NULL; }
+#endif
+
+        template<typename T>
+        TINYFORMAT_HIDDEN static void sinkFormatImpl(Sink& out, const FormatSpec& spec,
+                                                     const void* value)
         {
-            return convertToInt<T>::invoke(*static_cast<const T*>(value));
+            tinyformatTo(out, spec, *static_cast<const T*>(value));
         }
 
-        const void* m_value;
-        void (*m_formatImpl)(std::ostream& out, const char* fmtBegin,
-                             const char* fmtEnd, int ntrunc, const void* value);
-        int (*m_toIntImpl)(const void* value);
+        template<typename T>
+        static SinkFormatFunc sinkFormatter(BoolTag<false>) { return NULL; }
+        template<typename T>
+        static SinkFormatFunc sinkFormatter(BoolTag<true>) { return &sinkFormatImpl<T>; }
+
+        template<typename T>
+        TINYFORMAT_HIDDEN static int toIntImpl(const void* value)
+        {
+            return convertToInt<T>::invoke(*static_cast<const T*>(value));
+        }
+
+#ifdef TINYFORMAT_HAS_LAZY
+        static int lazyToIntImpl(const void* value)
+        {
+            return static_cast<const LazyArg*>(value)->resolve().toInt();
+        }
+#endif
+
+        const void* m_value;
+#ifndef TINYFORMAT_NO_IOSTREAM
+        StreamFormatFunc m_formatImpl;
+#endif
+        SinkFormatFunc m_sinkFormatImpl;
+        int (*m_toIntImpl)(const void* value);
+        ArgType m_type;
 };
 
 
@@ -576,14 +1390,147 @@ inline int parseIntAndAdvance(const char*& c)
     return i;
 }
 
+// Print literal part of format string and return next format spec position.
+//
+// Skips over any occurrences of '%%', printing a literal '%' to the output.
+// The position of the first % character of the next nontrivial format spec is
+// returned, or the end of string.
+inline const char* printFormatStringLiteral(Sink& out, const char* fmt)
+{
+    const char* c = fmt;
+    for (;; ++c) {
+        if (*c == '\0') {
+            out.append(fmt, static_cast<std::size_t>(c - fmt));
+            return c;
+        }
+        else if (*c == '%') {
+            out.append(fmt, static_cast<std::size_t>(c - fmt));
+            if (*(c+1) != '%')
+                return c;
+            // for "%%", tack trailing % onto next literal section.
+            fmt = ++c;
+        }
+    }
+}
+
+
+// Append the literal text at the start of `fmt` to `literals` with "%%"
+// replaced by '%', for parsing a format string ahead of time.  Returns a
+// pointer to the following conversion spec, or to the terminating null.
+inline const char* appendFormatStringLiteral(std::string& literals, const char* fmt)
+{
+    const char* c = fmt;
+    for (;; ++c) {
+        if (*c == '\0') {
+            literals.append(fmt, static_cast<std::size_t>(c - fmt));
+            return c;
+        }
+        else if (*c == '%') {
+            literals.append(fmt, static_cast<std::size_t>(c - fmt));
+            if (*(c+1) != '%')
+                return c;
+            fmt = ++c;
+        }
+    }
+}
+
+// Store `message` in `*error` if `error` is non-null, and return false, for
+// functions reporting failure through an optional error string.
+inline bool setError(std::string* error, const std::string& message)
+{
+    if (error)
+        *error = message;
+    return false;
+}
+
+
+// Formatting options parsed from a single conversion specification.
+//
+// The flags correspond one to one with the std::ios flags which tinyformat
+// uses, so a spec can either be applied to a stream with applyFormatSpec(),
+// or used to render built-in types directly with identical results.
+struct FormatSpec
+{
+    enum Flags
+    {
+        Left        = 1 << 0,
+        Internal    = 1 << 1,
+        Dec         = 1 << 2,
+        Oct         = 1 << 3,
+        Hex         = 1 << 4,
+        Fixed       = 1 << 5,
+        Scientific  = 1 << 6,
+        ShowBase    = 1 << 7,
+        ShowPoint   = 1 << 8,
+        ShowPos     = 1 << 9,
+        Uppercase   = 1 << 10,
+        BoolAlpha   = 1 << 11,
+        AdjustField = Left | Internal,
+        BaseField   = Dec | Oct | Hex,
+        FloatField  = Fixed | Scientific
+    };
+
+    // Argument references for argIndex, widthArg and precisionArg
+    enum ArgRef
+    {
+        NoArg   = -1,  // No argument: width or precision given literally
+        NextArg = -2   // Next unused argument, in non-positional mode
+    };
+
+    FormatSpec()
+        : width(0), precision(6), fill(' '), flags(0), conv('\0'),
+        ntrunc(-1), spacePadPositive(false), argIndex(NextArg),
+        widthArg(NoArg), precisionArg(NoArg), widthSet(false),
+        precisionSet(false)
+    { }
+
+    // Set the flags in `f`, clearing others in `mask` as for ios::setf()
+    void setf(unsigned f, unsigned mask) { flags = (flags & ~mask) | f; }
+
+    int width;
+    int precision;
+    char fill;
+    unsigned flags;
+    // Conversion specifier character, eg 'd'
+    char conv;
+    // Maximum number of characters for truncating conversions like "%.4s",
+    // or -1 for no truncation.
+    int ntrunc;
+    // Whether to pad positive numbers with a space ("% d"), which has no
+    // direct stream equivalent.
+    bool spacePadPositive;
+
+    // The remaining fields record the parts of the spec which depend on the
+    // argument list, and are used by resolveFormatSpec().
+    //
+    // Index of the argument to format ("%n$" gives n-1), or NextArg
+    int argIndex;
+    // Argument to read a variable width or precision from ("*" or "*n$"),
+    // as an index, NoArg or NextArg
+    int widthArg;
+    int precisionArg;
+    // Whether a width or precision appeared in the spec
+    bool widthSet;
+    bool precisionSet;
+};
+
+
+// Report an error in the format string.  If the caller passed a non-null
+// `error`, the message is stored there and the enclosing parse function
+// returns immediately; otherwise it's passed to TINYFORMAT_ERROR as usual.
+#define TINYFORMAT_PARSE_ERROR(reason)                                      \
+    do {                                                                    \
+        if (error) { *error = reason; return 0; }                           \
+        TINYFORMAT_ERROR(reason);                                           \
+    } while (false)
+
 // Parse width or precision `n` from format string pointer `c`, and advance it
-// to the next character. If an indirection is requested with `*`, the argument
-// is read from `args[argIndex]` and `argIndex` is incremented (or read
-// from `args[n]` in positional mode). Returns true if one or more
-// characters were read.
-inline bool parseWidthOrPrecision(int& n, const char*& c, bool positionalMode,
-                                  const detail::FormatArg* args,
-                                  int& argIndex, int numArgs)
+// to the next character.  If an indirection is requested with `*`, the index
+// of the argument to read it from is stored in `argRef` instead, to be read by
+// resolveFormatSpec(): either FormatSpec::NextArg, or the explicit index in
+// positional mode.  Returns true if one or more characters were read.
+inline bool parseWidthOrPrecision(int& n, int& argRef, const char*& c,
+                                  bool positionalMode, const char** error)
 {
     if (*c >= '0' && *c <= '9') {
         n = parseIntAndAdvance(c);
@@ -594,18 +1541,14 @@ inline bool parseWidthOrPrecision(int& n, const char*& c, bool positionalMode,
         if (positionalMode) {
             int pos = parseIntAndAdvance(c) - 1;
             if (*c != '$')
-                TINYFORMAT_ERROR("tinyformat: Non-positional argument used after a positional one");
-            if (pos >= 0 && pos < numArgs)
-                n = args[pos].toInt();
-            else
-                TINYFORMAT_ERROR("tinyformat: Positional argument out of range");
+                TINYFORMAT_PARSE_ERROR("tinyformat: Non-positional argument used after a positional one");
+            if (pos < 0)
+                TINYFORMAT_PARSE_ERROR("tinyformat: Positional argument out of range");
+            argRef = pos;
             ++c;
         }
         else {
-            if (argIndex < numArgs)
-                n = args[argIndex++].toInt();
-            else
-                TINYFORMAT_ERROR("tinyformat: Not enough arguments to read variable width or precision");
+            argRef = FormatSpec::NextArg;
         }
     }
     else {
@@ -614,31 +1557,7 @@ inline bool parseWidthOrPrecision(int& n, const char*& c, bool positionalMode,
     return true;
 }
 
-// Print literal part of format string and return next format spec position.
-//
-// Skips over any occurrences of '%%', printing a literal '%' to the output.
-// The position of the first % character of the next nontrivial format spec is
-// returned, or the end of string.
-inline const char* printFormatStringLiteral(std::ostream& out, const char* fmt)
-{
-    const char* c = fmt;
-    for (;; ++c) {
-        if (*c == '\0') {
-            out.write(fmt, c - fmt);
-            return c;
-        }
-        else if (*c == '%') {
-            out.write(fmt, c - fmt);
-            if (*(c+1) != '%')
-                return c;
-            // for "%%", tack trailing % onto next literal section.
-            fmt = ++c;
-        }
-    }
-}
-
-
-// Parse a format string and set the stream state accordingly.
+// Parse a format string into a FormatSpec.
 //
 // The format mini-language recognized here is meant to be the one from C99,
 // with the form "%[flags][width][.precision][length]type" with POSIX
@@ -666,29 +1585,20 @@ inline const char* printFormatStringLiteral(std::ostream& out, const char* fmt)
 // numbered arguments in the argument list can be referenced from the format
 // string as many times as required.
 //
-// Formatting options which can't be natively represented using the ostream
-// state are returned in spacePadPositive (for space padded positive numbers)
-// and ntrunc (for truncating conversions).  argIndex is incremented if
-// necessary to pull out variable width and precision.  The function returns a
-// pointer to the character after the end of the current format spec.
-inline const char* streamStateFromFormat(std::ostream& out, bool& positionalMode,
-                                         bool& spacePadPositive,
-                                         int& ntrunc, const char* fmtStart,
-                                         const detail::FormatArg* args,
-                                         int& argIndex, int numArgs)
+// Parsing only depends on the format string: references to arguments (for
+// the value itself and any variable width or precision) are recorded in the
+// spec, to be looked up in the argument list by resolveFormatSpec().  This
+// allows a format string to be parsed once and formatted many times.
+//
+// The function returns a pointer to the character after the end of the
+// current format spec.  Errors are reported with TINYFORMAT_ERROR, unless
+// `error` is non-null in which case the first error message is stored there
+// and null is returned.
+inline const char* parseFormatSpec(FormatSpec& spec, bool& positionalMode,
+                                   const char* fmtStart,
+                                   const char** error = 0)
 {
     TINYFORMAT_ASSERT(*fmtStart == '%');
-    // Reset stream state to defaults.
-    out.width(0);
-    out.precision(6);
-    out.fill(' ');
-    // Reset most flags; ignore irrelevant unitbuf & skipws.
-    out.unsetf(std::ios::adjustfield | std::ios::basefield |
-               std::ios::floatfield | std::ios::showbase | std::ios::boolalpha |
-               std::ios::showpoint | std::ios::showpos | std::ios::uppercase);
-    bool precisionSet = false;
-    bool widthSet = false;
-    int widthExtra = 0;
     const char* c = fmtStart + 1;
 
     // 1) Parse an argument index (if followed by '$') or a width possibly
@@ -698,63 +1608,62 @@ inline const char* streamStateFromFormat(std::ostream& out, bool& positionalMode
         int value = parseIntAndAdvance(c);
         if (*c == '$') {
             // value is an argument index
-            if (value > 0 && value <= numArgs)
-                argIndex = value - 1;
+            if (value > 0)
+                spec.argIndex = value - 1;
             else
-                TINYFORMAT_ERROR("tinyformat: Positional argument out of range");
+                TINYFORMAT_PARSE_ERROR("tinyformat: Positional argument out of range");
             ++c;
             positionalMode = true;
         }
         else if (positionalMode) {
-            TINYFORMAT_ERROR("tinyformat: Non-positional argument used after a positional one");
+            TINYFORMAT_PARSE_ERROR("tinyformat: Non-positional argument used after a positional one");
         }
         else {
             if (tmpc == '0') {
                 // Use internal padding so that numeric values are
                 // formatted correctly, eg -00010 rather than 000-10
-                out.fill('0');
-                out.setf(std::ios::internal, std::ios::adjustfield);
+                spec.fill = '0';
+                spec.setf(FormatSpec::Internal, FormatSpec::AdjustField);
             }
             if (value != 0) {
                 // Nonzero value means that we parsed width.
-                widthSet = true;
-                out.width(value);
+                spec.widthSet = true;
+                spec.width = value;
             }
         }
     }
     else if (positionalMode) {
-        TINYFORMAT_ERROR("tinyformat: Non-positional argument used after a positional one");
+        TINYFORMAT_PARSE_ERROR("tinyformat: Non-positional argument used after a positional one");
     }
     // 2) Parse flags and width if we did not do it in previous step.
-    if (!widthSet) {
+    if (!spec.widthSet) {
         // Parse flags
         for (;; ++c) {
             switch (*c) {
                 case '#':
-                    out.setf(std::ios::showpoint | std::ios::showbase);
+                    spec.flags |= FormatSpec::ShowPoint | FormatSpec::ShowBase;
                     continue;
                 case '0':
                     // overridden by left alignment ('-' flag)
-                    if (!(out.flags() & std::ios::left)) {
+                    if (!(spec.flags & FormatSpec::Left)) {
                         // Use internal padding so that numeric values are
                         // formatted correctly, eg -00010 rather than 000-10
-                        out.fill('0');
-                        out.setf(std::ios::internal, std::ios::adjustfield);
+                        spec.fill = '0';
+                        spec.setf(FormatSpec::Internal, FormatSpec::AdjustField);
                     }
                     continue;
                 case '-':
-                    out.fill(' ');
-                    out.setf(std::ios::left, std::ios::adjustfield);
+                    spec.fill = ' ';
+                    spec.setf(FormatSpec::Left, FormatSpec::AdjustField);
                     continue;
                 case ' ':
                     // overridden by show positive sign, '+' flag.
-                    if (!(out.flags() & std::ios::showpos))
-                        spacePadPositive = true;
+                    if (!(spec.flags & FormatSpec::ShowPos))
+                        spec.spacePadPositive = true;
                     continue;
                 case '+':
-                    out.setf(std::ios::showpos);
-                    spacePadPositive = false;
-                    widthExtra = 1;
+                    spec.flags |= FormatSpec::ShowPos;
+                    spec.spacePadPositive = false;
                     continue;
                 default:
                     break;
@@ -762,30 +1671,24 @@ inline const char* streamStateFromFormat(std::ostream& out, bool& positionalMode
             break;
         }
         // Parse width
-        int width = 0;
-        widthSet = parseWidthOrPrecision(width, c, positionalMode,
-                                         args, argIndex, numArgs);
-        if (widthSet) {
-            if (width < 0) {
-                // negative widths correspond to '-' flag set
-                out.fill(' ');
-                out.setf(std::ios::left, std::ios::adjustfield);
-                width = -width;
-            }
-            out.width(width);
-        }
+        spec.widthSet = parseWidthOrPrecision(spec.width, spec.widthArg, c,
+                                              positionalMode, error);
+        if (error && *error)
+            return 0;
     }
     // 3) Parse precision
     if (*c == '.') {
         ++c;
         int precision = 0;
-        parseWidthOrPrecision(precision, c, positionalMode,
-                              args, argIndex, numArgs);
-        // Presence of `.` indicates precision set, unless the inferred value
-        // was negative in which case the default is used.
-        precisionSet = precision >= 0;
-        if (precisionSet)
-            out.precision(precision);
+        parseWidthOrPrecision(precision, spec.precisionArg, c,
+                              positionalMode, error);
+        if (error && *error)
+            return 0;
+        // Presence of `.` indicates precision set.  (A variable precision may
+        // still turn out to be negative, in which case the default is used.)
+        spec.precisionSet = true;
+        if (spec.precisionArg == FormatSpec::NoArg)
+            spec.precision = precision;
     }
     // 4) Ignore any C99 length modifier
     while (*c == 'l' || *c == 'h' || *c == 'L' ||
@@ -795,362 +1698,2172 @@ inline const char* streamStateFromFormat(std::ostream& out, bool& positionalMode
     // 5) We're up to the conversion specifier character.
     // Set stream flags based on conversion specifier (thanks to the
     // boost::format class for forging the way here).
-    bool intConversion = false;
+    spec.conv = *c;
     switch (*c) {
         case 'u': case 'd': case 'i':
-            out.setf(std::ios::dec, std::ios::basefield);
-            intConversion = true;
+            spec.setf(FormatSpec::Dec, FormatSpec::BaseField);
             break;
         case 'o':
-            out.setf(std::ios::oct, std::ios::basefield);
-            intConversion = true;
+            spec.setf(FormatSpec::Oct, FormatSpec::BaseField);
             break;
         case 'X':
-            out.setf(std::ios::uppercase);
+            spec.flags |= FormatSpec::Uppercase;
             // Falls through
         case 'x': case 'p':
-            out.setf(std::ios::hex, std::ios::basefield);
-            intConversion = true;
+            spec.setf(FormatSpec::Hex, FormatSpec::BaseField);
             break;
         case 'E':
-            out.setf(std::ios::uppercase);
+            spec.flags |= FormatSpec::Uppercase;
             // Falls through
         case 'e':
-            out.setf(std::ios::scientific, std::ios::floatfield);
-            out.setf(std::ios::dec, std::ios::basefield);
+            spec.setf(FormatSpec::Scientific, FormatSpec::FloatField);
+            spec.setf(FormatSpec::Dec, FormatSpec::BaseField);
             break;
         case 'F':
-            out.setf(std::ios::uppercase);
+            spec.flags |= FormatSpec::Uppercase;
             // Falls through
         case 'f':
-            out.setf(std::ios::fixed, std::ios::floatfield);
+            spec.setf(FormatSpec::Fixed, FormatSpec::FloatField);
             break;
         case 'A':
-            out.setf(std::ios::uppercase);
+            spec.flags |= FormatSpec::Uppercase;
             // Falls through
         case 'a':
-#           ifdef _MSC_VER
-            // Workaround https://developercommunity.visualstudio.com/content/problem/520472/hexfloat-stream-output-does-not-ignore-precision-a.html
-            // by always setting maximum precision on MSVC to avoid precision
-            // loss for doubles.
-            out.precision(13);
-#           endif
-            out.setf(std::ios::fixed | std::ios::scientific, std::ios::floatfield);
+            spec.setf(FormatSpec::Fixed | FormatSpec::Scientific, FormatSpec::FloatField);
             break;
         case 'G':
-            out.setf(std::ios::uppercase);
+            spec.flags |= FormatSpec::Uppercase;
             // Falls through
         case 'g':
-            out.setf(std::ios::dec, std::ios::basefield);
+            spec.setf(FormatSpec::Dec, FormatSpec::BaseField);
             // As in boost::format, let stream decide float format.
-            out.flags(out.flags() & ~std::ios::floatfield);
+            spec.flags &= ~FormatSpec::FloatField;
             break;
         case 'c':
             // Handled as special case inside formatValue()
             break;
         case 's':
-            if (precisionSet)
-                ntrunc = static_cast<int>(out.precision());
             // Make %s print Booleans as "true" and "false"
-            out.setf(std::ios::boolalpha);
+            spec.flags |= FormatSpec::BoolAlpha;
             break;
         case 'n':
             // Not supported - will cause problems!
-            TINYFORMAT_ERROR("tinyformat: %n conversion spec not supported");
+            TINYFORMAT_PARSE_ERROR("tinyformat: %n conversion spec not supported");
             break;
         case '\0':
-            TINYFORMAT_ERROR("tinyformat: Conversion spec incorrectly "
-                             "terminated by end of string");
+            TINYFORMAT_PARSE_ERROR("tinyformat: Conversion spec incorrectly "
+                                   "terminated by end of string");
             return c;
         default:
             break;
     }
-    if (intConversion && precisionSet && !widthSet) {
-        // "precision" for integers gives the minimum number of digits (to be
-        // padded with zeros on the left).  This isn't really supported by the
-        // iostreams, but we can approximately simulate it with the width if
-        // the width isn't otherwise used.
-        out.width(out.precision() + widthExtra);
-        out.setf(std::ios::internal, std::ios::adjustfield);
-        out.fill('0');
-    }
     return c+1;
 }
 
+#undef TINYFORMAT_PARSE_ERROR
 
-//------------------------------------------------------------------------------
-inline void formatImpl(std::ostream& out, const char* fmt,
-                       const detail::FormatArg* args,
-                       int numArgs)
+
+// Read a variable width or precision from the argument referenced by `ref`,
+// which is either an index or FormatSpec::NextArg.
+inline int readIntArg(int ref, const detail::FormatArg* args, int& argIndex,
+                      int numArgs)
 {
-    // Saved stream state
-    std::streamsize origWidth = out.width();
-    std::streamsize origPrecision = out.precision();
-    std::ios::fmtflags origFlags = out.flags();
-    char origFill = out.fill();
+    if (ref == FormatSpec::NextArg) {
+        if (argIndex < numArgs)
+            return args[argIndex++].toInt();
+        TINYFORMAT_ERROR("tinyformat: Not enough arguments to read variable width or precision");
+    }
+    else if (ref < numArgs) {
+        return args[ref].toInt();
+    }
+    else {
+        TINYFORMAT_ERROR("tinyformat: Positional argument out of range");
+    }
+    return 0;
+}
 
-    // "Positional mode" means all format specs should be of the form "%n$..."
-    // with `n` an integer. We detect this in `streamStateFromFormat`.
-    bool positionalMode = false;
-    int argIndex = 0;
-    while (true) {
-        fmt = printFormatStringLiteral(out, fmt);
-        if (*fmt == '\0') {
-            if (!positionalMode && argIndex < numArgs) {
-                TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
-            }
-            break;
-        }
-        bool spacePadPositive = false;
-        int ntrunc = -1;
-        const char* fmtEnd = streamStateFromFormat(out, positionalMode, spacePadPositive, ntrunc, fmt,
-                                                   args, argIndex, numArgs);
-        // NB: argIndex may be incremented by reading variable width/precision
-        // in `streamStateFromFormat`, so do the bounds check here.
-        if (argIndex >= numArgs) {
-            TINYFORMAT_ERROR("tinyformat: Too many conversion specifiers in format string");
-            return;
-        }
-        const FormatArg& arg = args[argIndex];
-        // Format the arg into the stream.
-        if (!spacePadPositive) {
-            arg.format(out, fmt, fmtEnd, ntrunc);
+// Look up the argument references recorded in `spec` by parseFormatSpec(),
+// filling in any variable width and precision from the argument list, and
+// make the adjustments which depend on them.
+//
+// Arguments consumed in non-positional mode are taken starting from
+// `argIndex`, which is left as the index of the argument to be formatted.
+inline void resolveFormatSpec(FormatSpec& spec, const detail::FormatArg* args,
+                              int& argIndex, int numArgs)
+{
+    if (spec.widthArg != FormatSpec::NoArg) {
+        int width = readIntArg(spec.widthArg, args, argIndex, numArgs);
+        if (width < 0) {
+            // negative widths correspond to '-' flag set
+            spec.fill = ' ';
+            spec.setf(FormatSpec::Left, FormatSpec::AdjustField);
+            width = -width;
         }
-        else {
-            // The following is a special case with no direct correspondence
-            // between stream formatting and the printf() behaviour.  Simulate
-            // it crudely by formatting into a temporary string stream and
-            // munging the resulting string.
-            std::ostringstream tmpStream;
-            tmpStream.copyfmt(out);
-            tmpStream.setf(std::ios::showpos);
-            arg.format(tmpStream, fmt, fmtEnd, ntrunc);
-            std::string result = tmpStream.str(); // allocates... yuck.
-            for (size_t i = 0, iend = result.size(); i < iend; ++i) {
-                if (result[i] == '+')
-                    result[i] = ' ';
+        spec.width = width;
+    }
+    if (spec.precisionArg != FormatSpec::NoArg) {
+        int precision = readIntArg(spec.precisionArg, args, argIndex, numArgs);
+        if (precision >= 0)
+            spec.precision = precision;
+        else
+            spec.precisionSet = false;
+    }
+#   ifdef _MSC_VER
+    if (spec.conv == 'a' || spec.conv == 'A') {
+        // Workaround https://developercommunity.visualstudio.com/content/problem/520472/hexfloat-stream-output-does-not-ignore-precision-a.html
+        // by always setting maximum precision on MSVC to avoid precision
+        // loss for doubles.
+        spec.precision = 13;
+    }
+#   endif
+    if (spec.argIndex != FormatSpec::NextArg) {
+        if (spec.argIndex < numArgs)
+            argIndex = spec.argIndex;
+        else
+            TINYFORMAT_ERROR("tinyformat: Positional argument out of range");
+    }
+    if (!spec.precisionSet)
+        return;
+    switch (spec.conv) {
+        case 's':
+            spec.ntrunc = spec.precision;
+            break;
+        case 'u': case 'd': case 'i': case 'o': case 'X': case 'x': case 'p':
+            if (!spec.widthSet) {
+                // "precision" for integers gives the minimum number of digits
+                // (to be padded with zeros on the left).  This isn't really
+                // supported by the iostreams, but we can approximately
+                // simulate it with the width if the width isn't otherwise
+                // used.
+                spec.width = spec.precision +
+                             ((spec.flags & FormatSpec::ShowPos) ? 1 : 0);
+                spec.setf(FormatSpec::Internal, FormatSpec::AdjustField);
+                spec.fill = '0';
             }
-            out << result;
-        }
-        if (!positionalMode)
-            ++argIndex;
-        fmt = fmtEnd;
+            break;
+        default:
+            break;
     }
-
-    // Restore stream state
-    out.width(origWidth);
-    out.precision(origPrecision);
-    out.flags(origFlags);
-    out.fill(origFill);
 }
 
-} // namespace detail
-
 
-/// List of template arguments format(), held in a type-opaque way.
-///
-/// A const reference to FormatList (typedef'd as FormatListRef) may be
-/// conveniently used to pass arguments to non-template functions: All type
-/// information has been stripped from the arguments, leaving just enough of a
-/// common interface to perform formatting as required.
-class FormatList
+#ifndef TINYFORMAT_NO_IOSTREAM
+// Set the stream state according to a parsed format spec.
+inline void applyFormatSpec(std::ostream& out, const FormatSpec& spec)
 {
-    public:
-        FormatList(detail::FormatArg* args, int N)
-            : m_args(args), m_N(N) { }
-
-        friend void vformat(std::ostream& out, const char* fmt,
-                            const FormatList& list);
-
-    private:
-        const detail::FormatArg* m_args;
-        int m_N;
-};
-
-/// Reference to type-opaque format list for passing to vformat()
-typedef const FormatList& FormatListRef;
-
+    out.width(spec.width);
+    out.precision(spec.precision);
+    out.fill(spec.fill);
+    // Reset most flags; ignore irrelevant unitbuf & skipws.
+    std::ios::fmtflags flags = out.flags() &
+        ~(std::ios::adjustfield | std::ios::basefield | std::ios::floatfield |
+          std::ios::showbase | std::ios::boolalpha | std::ios::showpoint |
+          std::ios::showpos | std::ios::uppercase);
+    const unsigned f = spec.flags;
+    if (f & FormatSpec::Left)       flags |= std::ios::left;
+    if (f & FormatSpec::Internal)   flags |= std::ios::internal;
+    if (f & FormatSpec::Dec)        flags |= std::ios::dec;
+    if (f & FormatSpec::Oct)        flags |= std::ios::oct;
+    if (f & FormatSpec::Hex)        flags |= std::ios::hex;
+    if (f & FormatSpec::Fixed)      flags |= std::ios::fixed;
+    if (f & FormatSpec::Scientific) flags |= std::ios::scientific;
+    if (f & FormatSpec::ShowBase)   flags |= std::ios::showbase;
+    if (f & FormatSpec::ShowPoint)  flags |= std::ios::showpoint;
+    if (f & FormatSpec::ShowPos)    flags |= std::ios::showpos;
+    if (f & FormatSpec::Uppercase)  flags |= std::ios::uppercase;
+    if (f & FormatSpec::BoolAlpha)  flags |= std::ios::boolalpha;
+    out.flags(flags);
+}
+#endif
 
-namespace detail {
 
-// Format list subclass with fixed storage to avoid dynamic allocation
-template<std::size_t N>
-class FormatListN : public FormatList
+//------------------------------------------------------------------------------
+// Native formatting of built-in types.
+//
+// The functions below render built-in types straight from a FormatSpec,
+// producing exactly the output which the standard stream inserters would
+// produce in the classic "C" locale, but without the locale facet lookups,
+// virtual calls and stream state manipulation.
+
+// Size of the stack buffer used to render numbers.  Conversions which need
+// more space (eg, "%.500f") are rendered into a heap buffer instead.
+const int nativeBufSize = 128;
+
+// Return the length of any leading sign or "0x" prefix of numeric output,
+// after which std::num_put places padding for "internal" adjustment.
+inline std::size_t numericPrefixLen(const char* s, std::size_t len)
 {
-    public:
-#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
-        template<typename... Args>
-        FormatListN(const Args&... args)
-            : FormatList(&m_formatterStore[0], N),
-            m_formatterStore { FormatArg(args)... }
-        { static_assert(sizeof...(args) == N, "Number of args must be N"); }
-#else // C++98 version
-        void init(int) {}
-#       define TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR(n)                \
-                                                                        \
-        template<TINYFORMAT_ARGTYPES(n)>                                \
-        FormatListN(TINYFORMAT_VARARGS(n))                              \
-            : FormatList(&m_formatterStore[0], n)                       \
-        { TINYFORMAT_ASSERT(n == N); init(0, TINYFORMAT_PASSARGS(n)); } \
-                                                                        \
-        template<TINYFORMAT_ARGTYPES(n)>                                \
-        void init(int i, TINYFORMAT_VARARGS(n))                         \
-        {                                                               \
-            m_formatterStore[i] = FormatArg(v1);                        \
-            init(i+1 TINYFORMAT_PASSARGS_TAIL(n));                      \
-        }
-
-        TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR)
-#       undef TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR
-#endif
-        FormatListN(const FormatListN& other)
-            : FormatList(&m_formatterStore[0], N)
-        { std::copy(&other.m_formatterStore[0], &other.m_formatterStore[N],
-                    &m_formatterStore[0]); }
+    if (len > 0 && (s[0] == '-' || s[0] == '+'))
+        return 1;
+    if (len > 1 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+        return 2;
+    return 0;
+}
 
-    private:
-        FormatArg m_formatterStore[N];
-};
+// Write [s, s+len) padded to the field width of `spec` using character
+// `fill`.  For "internal" adjustment the padding is inserted after the first
+// prefixLen characters, which should be zero for non-numeric output.
+inline void writePadded(Sink& out, const FormatSpec& spec, char fill,
+                        const char* s, std::size_t len,
+                        std::size_t prefixLen = 0)
+{
+    if (spec.width <= 0 || static_cast<std::size_t>(spec.width) <= len) {
+        out.append(s, len);
+        return;
+    }
+    std::size_t npad = static_cast<std::size_t>(spec.width) - len;
+    if (spec.flags & FormatSpec::Left) {
+        out.append(s, len);
+        out.fill(fill, npad);
+    }
+    else {
+        if (!(spec.flags & FormatSpec::Internal))
+            prefixLen = 0;
+        out.append(s, prefixLen);
+        out.fill(fill, npad);
+        out.append(s + prefixLen, len - prefixLen);
+    }
+}
 
-// Special 0-arg version - MSVC says zero-sized C array in struct is nonstandard
-template<> class FormatListN<0> : public FormatList
+// Tables of digit pairs, for rendering integers a byte (or six bits, for
+// octal) at a time.  The dummy template parameter allows the definitions to
+// live in the header.
+template<int dummy>
+struct DigitPairs
 {
-    public: FormatListN() : FormatList(0, 0) {}
+    static const char hexLower[513];
+    static const char hexUpper[513];
+    static const char oct[129];
 };
 
-} // namespace detail
-
-
-//------------------------------------------------------------------------------
-// Primary API functions
-
-#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
-
-/// Make type-agnostic format list from list of template arguments.
-///
-/// The exact return type of this function is an implementation detail and
-/// shouldn't be relied upon.  Instead it should be stored as a FormatListRef:
-///
-///   FormatListRef formatList = makeFormatList( /*...*/ );
-template<typename... Args>
-detail::FormatListN<sizeof...(Args)> makeFormatList(const Args&... args)
+template<int dummy>
+const char DigitPairs<dummy>::hexLower[513] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+template<int dummy>
+const char DigitPairs<dummy>::hexUpper[513] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+template<int dummy>
+const char DigitPairs<dummy>::oct[129] =
+    "0001020304050607101112131415161720212223242526273031323334353637"
+    "4041424344454647505152535455565760616263646566677071727374757677";
+
+// Prepend the two characters at `pair` to the output ending at `p`.
+inline char* prependPair(char* p, const char* pair)
 {
-    return detail::FormatListN<sizeof...(args)>(args...);
+    p -= 2;
+    p[0] = pair[0];
+    p[1] = pair[1];
+    return p;
 }
 
-#else // C++98 version
-
-inline detail::FormatListN<0> makeFormatList()
+// Render an integer with magnitude `value` backward from `end` according to
+// the std::num_put rules for the given flags, returning the start of the
+// output.  Octal and hex output never has a sign.
+inline char* formatIntegerBackward(char* end, unsigned long long value,
+                                   bool negative, bool isSigned,
+                                   unsigned flags)
 {
-    return detail::FormatListN<0>();
-}
-#define TINYFORMAT_MAKE_MAKEFORMATLIST(n)                     \
-template<TINYFORMAT_ARGTYPES(n)>                              \
-detail::FormatListN<n> makeFormatList(TINYFORMAT_VARARGS(n))  \
-{                                                             \
-    return detail::FormatListN<n>(TINYFORMAT_PASSARGS(n));    \
+    char* p = end;
+    const bool hasValue = value != 0;
+    if (flags & FormatSpec::Hex) {
+        const char* pairs = (flags & FormatSpec::Uppercase) ?
+                            DigitPairs<0>::hexUpper : DigitPairs<0>::hexLower;
+        for (; value >= 0x100; value >>= 8)
+            p = prependPair(p, pairs + 2*(value & 0xff));
+        if (value >= 0x10)
+            p = prependPair(p, pairs + 2*value);
+        else
+            *--p = pairs[2*value + 1];
+        if ((flags & FormatSpec::ShowBase) && hasValue) {
+            *--p = (flags & FormatSpec::Uppercase) ? 'X' : 'x';
+            *--p = '0';
+        }
+    }
+    else if (flags & FormatSpec::Oct) {
+        const char* pairs = DigitPairs<0>::oct;
+        for (; value >= 0100; value >>= 6)
+            p = prependPair(p, pairs + 2*(value & 077));
+        if (value >= 010)
+            p = prependPair(p, pairs + 2*value);
+        else
+            *--p = pairs[2*value + 1];
+        if ((flags & FormatSpec::ShowBase) && hasValue)
+            *--p = '0';
+    }
+    else {
+        do {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        if (negative)
+            *--p = '-';
+        else if (isSigned && (flags & FormatSpec::ShowPos))
+            *--p = '+';
+    }
+    return p;
 }
-TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_MAKEFORMATLIST)
-#undef TINYFORMAT_MAKE_MAKEFORMATLIST
-
-#endif
 
-/// Format list of arguments to the stream according to the given format string.
-///
-/// The name vformat() is chosen for the semantic similarity to vprintf(): the
-/// list of format arguments is held in a single function argument.
-inline void vformat(std::ostream& out, const char* fmt, FormatListRef list)
+// Render integer `value` of type T with unsigned counterpart U.  As for
+// std::ostream, negative values are shown as unsigned in octal and hex.
+template<typename T, typename U>
+inline char* formatIntBackward(char* end, T value, bool isSigned, unsigned flags)
 {
-    detail::formatImpl(out, fmt, list.m_args, list.m_N);
+    if (flags & (FormatSpec::Oct | FormatSpec::Hex))
+        return formatIntegerBackward(end, static_cast<U>(value), false, false, flags);
+    const bool negative = isSigned && value < T(0);
+    const U magnitude = negative ? static_cast<U>(U(0) - static_cast<U>(value))
+                                 : static_cast<U>(value);
+    return formatIntegerBackward(end, magnitude, negative, isSigned, flags);
 }
 
+template<typename T> struct FloatLengthModifier { static const char value = '\0'; };
+template<> struct FloatLengthModifier<long double> { static const char value = 'L'; };
 
-#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+// Render floating point `value` into buf according to the std::num_put rules
+// for the given flags and precision, as if in the "C" locale.  Returns the
+// length of the output, or -1 on error.  If the returned length is not less
+// than bufSize the output didn't fit, and the call should be repeated with a
+// buffer of at least that length plus one.
+template<typename T>
+inline int formatFloat(char* buf, int bufSize, T value, unsigned flags, int precision)
+{
+    // Build a printf format string in the same way as std::num_put
+    char fmt[8];
+    char* f = fmt;
+    *f++ = '%';
+    if (flags & FormatSpec::ShowPos)
+        *f++ = '+';
+    if (flags & FormatSpec::ShowPoint)
+        *f++ = '#';
+    const unsigned floatField = flags & FormatSpec::FloatField;
+    const bool upper = (flags & FormatSpec::Uppercase) != 0;
+    // Precision is always used, except for hexfloat
+    if (floatField != FormatSpec::FloatField) {
+        *f++ = '.';
+        *f++ = '*';
+    }
+    if (FloatLengthModifier<T>::value)
+        *f++ = FloatLengthModifier<T>::value;
+    if (floatField == FormatSpec::FloatField)
+        *f++ = upper ? 'A' : 'a';
+    else if (floatField == FormatSpec::Fixed)
+        *f++ = 'f';
+    else if (floatField == FormatSpec::Scientific)
+        *f++ = upper ? 'E' : 'e';
+    else
+        *f++ = upper ? 'G' : 'g';
+    *f = '\0';
+    int len = (floatField == FormatSpec::FloatField) ?
+              TINYFORMAT_SNPRINTF(buf, bufSize, fmt, value) :
+              TINYFORMAT_SNPRINTF(buf, bufSize, fmt, precision < 0 ? 6 : precision, value);
+    if (len < 0 || len >= bufSize)
+        return len;
+    // snprintf() uses the decimal point of the C library locale; replace
+    // anything unexpected with '.' to get "C" locale output regardless.
+    int n = 0;
+    for (int i = 0; i < len; ++i) {
+        const char c = buf[i];
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+            (c >= 'A' && c <= 'Z') || c == '+' || c == '-' || c == '.')
+            buf[n++] = c;
+        else if (n == 0 || buf[n-1] != '.')
+            buf[n++] = '.';
+    }
+    return n;
+}
 
-/// Format list of arguments to the stream according to given format string.
-template<typename... Args>
-void format(std::ostream& out, const char* fmt, const Args&... args)
+// Write a single character, as for the stream inserter for char
+inline void formatCharNative(Sink& out, const FormatSpec& spec, char fill, char c)
 {
-    vformat(out, fmt, makeFormatList(args...));
+    if (spec.spacePadPositive && c == '+')
+        c = ' ';
+    writePadded(out, spec, fill, &c, 1);
 }
 
-/// Format list of arguments according to the given format string and return
-/// the result as a string.
+// Write rendered numeric output, emulating the crude "% d" handling used for
+// the stream based formatting.
+inline void writeNumericNative(Sink& out, const FormatSpec& spec, char fill,
+                               char* s, std::size_t len)
+{
+    const std::size_t prefixLen = numericPrefixLen(s, len);
+    if (spec.spacePadPositive) {
+        for (std::size_t i = 0; i < len; ++i) {
+            if (s[i] == '+')
+                s[i] = ' ';
+        }
+    }
+    writePadded(out, spec, fill, s, len, prefixLen);
+}
+
+template<typename T, typename U>
+inline bool formatIntNative(Sink& out, const FormatSpec& spec, T value, bool isSigned)
+{
+    if (spec.conv == 'c') {
+        formatCharNative(out, spec, spec.fill, static_cast<char>(value));
+        return true;
+    }
+    unsigned flags = spec.flags;
+    if (spec.spacePadPositive)
+        flags |= FormatSpec::ShowPos;
+    char buf[nativeBufSize];
+    char* end = buf + nativeBufSize;
+    char* start = formatIntBackward<T, U>(end, value, isSigned, flags);
+    writeNumericNative(out, spec, spec.fill, start, static_cast<std::size_t>(end - start));
+    return true;
+}
+
+// Return whether `value` is neither infinite nor NaN, without <cmath>: the
+// difference is NaN for both.
+template<typename T>
+inline bool isFiniteValue(T value)
+{
+    return value - value == value - value;
+}
+
+template<typename T>
+inline bool formatFloatNative(Sink& out, const FormatSpec& spec, T value)
+{
+    // Zero padding doesn't make sense for inf and nan
+    const char fill = (spec.fill == '0' && !isFiniteValue(value)) ? ' ' : spec.fill;
+    if (spec.conv == 'c') {
+        formatCharNative(out, spec, fill, static_cast<char>(value));
+        return true;
+    }
+    unsigned flags = spec.flags;
+    if (spec.spacePadPositive)
+        flags |= FormatSpec::ShowPos;
+    char buf[nativeBufSize];
+    int len = formatFloat(buf, nativeBufSize, value, flags, spec.precision);
+    if (len < 0)
+        return false;
+    if (len < nativeBufSize) {
+        writeNumericNative(out, spec, fill, buf, static_cast<std::size_t>(len));
+        return true;
+    }
+    std::string bigBuf(static_cast<std::size_t>(len) + 1, '\0');
+    len = formatFloat(&bigBuf[0], len + 1, value, flags, spec.precision);
+    if (len < 0 || static_cast<std::size_t>(len) >= bigBuf.size())
+        return false;
+    writeNumericNative(out, spec, fill, &bigBuf[0], static_cast<std::size_t>(len));
+    return true;
+}
+
+inline bool formatPointerNative(Sink& out, const FormatSpec& spec, const void* value)
+{
+#if defined(_MSC_VER) && !defined(TINYFORMAT_NO_IOSTREAM)
+    // MSVC formats pointers differently; leave this to the stream.
+    (void) out; (void) spec; (void) value;
+    return false;
+#else
+    // Pointers are always shown in lower case hex with a 0x prefix
+    const unsigned flags = (spec.flags & ~(FormatSpec::BaseField | FormatSpec::Uppercase)) |
+                           FormatSpec::Hex | FormatSpec::ShowBase;
+    char buf[nativeBufSize];
+    char* end = buf + nativeBufSize;
+    char* start = formatIntegerBackward(end, reinterpret_cast<unsigned long long>(value),
+                                        false, false, flags);
+    const std::size_t len = static_cast<std::size_t>(end - start);
+    writePadded(out, spec, spec.fill, start, len, numericPrefixLen(start, len));
+    return true;
+#endif
+}
+
+// Sink forwarding at most `limit` characters to another sink and discarding
+// the rest, used for truncating conversions like "%.4s".  If spacePad is
+// true, '+' is also replaced with ' ' to simulate the crude stream based
+// handling of "% s".
+class TruncatingSink : public Sink
+{
+    public:
+        TruncatingSink(Sink& out, std::size_t limit, bool spacePad)
+            : m_out(out), m_remaining(limit), m_spacePad(spacePad) { }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            n = (std::min)(n, m_remaining);
+            m_remaining -= n;
+            if (!m_spacePad) {
+                m_out.append(s, n);
+                return;
+            }
+            const char* runStart = s;
+            const char* end = s + n;
+            for (const char* c = s; c != end; ++c) {
+                if (*c == '+') {
+                    m_out.append(runStart, static_cast<std::size_t>(c - runStart));
+                    m_out.put(' ');
+                    runStart = c + 1;
+                }
+            }
+            m_out.append(runStart, static_cast<std::size_t>(end - runStart));
+        }
+
+        virtual void overflowFill(char c, std::size_t n)
+        {
+            n = (std::min)(n, m_remaining);
+            m_remaining -= n;
+            m_out.fill((m_spacePad && c == '+') ? ' ' : c, n);
+        }
+
+    private:
+        Sink& m_out;
+        std::size_t m_remaining;
+        bool m_spacePad;
+};
+
+// Sink writing to a fixed size buffer, first discarding `skip` characters
+// of output which were written out by an earlier call, and dropping any
+// output past the end of the buffer.
+class ChunkSink : public Sink
+{
+    public:
+        ChunkSink(char* buf, std::size_t bufSize, std::size_t skip)
+            : m_buf(buf), m_bufEnd(buf + bufSize), m_skip(skip), m_dropped(false)
+        {
+            setWindow(buf, skip == 0 ? m_bufEnd : buf);
+        }
+
+        std::size_t size() const { return static_cast<std::size_t>(windowPos() - m_buf); }
+        bool full() const { return windowPos() == m_bufEnd; }
+        // Whether any output didn't fit in the buffer
+        bool dropped() const { return m_dropped; }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            const std::size_t nskip = skip(n);
+            append(s + nskip, fit(n - nskip));
+        }
+
+        virtual void overflowFill(char c, std::size_t n)
+        {
+            fill(c, fit(n - skip(n)));
+        }
+
+    private:
+        // Consume up to n characters of the output to be skipped, opening
+        // the window once it's all been skipped.
+        std::size_t skip(std::size_t n)
+        {
+            if (m_skip == 0)
+                return 0;
+            const std::size_t nskip = (std::min)(m_skip, n);
+            m_skip -= nskip;
+            if (m_skip == 0)
+                setWindow(m_buf, m_bufEnd);
+            return nskip;
+        }
+
+        // Return how many of n characters fit in the window
+        std::size_t fit(std::size_t n)
+        {
+            const std::size_t nfit = (std::min)(n, static_cast<std::size_t>(m_bufEnd - windowPos()));
+            if (nfit < n)
+                m_dropped = true;
+            return nfit;
+        }
+
+        char* m_buf;
+        char* m_bufEnd;
+        std::size_t m_skip;
+        bool m_dropped;
+};
+
+// Sink collecting output in a stack buffer of bufSize characters, moving
+// it to the heap only if it's unusually long.
+template<std::size_t bufSize>
+class StackBuffer : public Sink
+{
+    public:
+        StackBuffer() : m_spilled(false) { setWindow(m_buf, m_buf + bufSize); }
+
+        const char* data() const { return m_spilled ? m_heapBuf.data() : m_buf; }
+        std::size_t size() const
+        {
+            return m_spilled ? m_heapBuf.size()
+                             : static_cast<std::size_t>(windowPos() - m_buf);
+        }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            if (!m_spilled) {
+                m_heapBuf.assign(m_buf, size());
+                setWindow(0, 0);
+                m_spilled = true;
+            }
+            m_heapBuf.append(s, n);
+        }
+
+    private:
+        char m_buf[bufSize];
+        std::string m_heapBuf;
+        bool m_spilled;
+};
+
+// Buffer for the output of a single field, so that it can be padded to the
+// field width once its length is known.
+typedef StackBuffer<nativeBufSize> FieldBuffer;
+
+// Write the contents of `field` padded to the field width of `spec`.  As for
+// numbers, zero padding goes after any leading sign or "0x".
+inline void writeField(Sink& out, const FormatSpec& spec, const FieldBuffer& field)
+{
+    writePadded(out, spec, spec.fill, field.data(), field.size(),
+                numericPrefixLen(field.data(), field.size()));
+}
+
+inline bool formatStringNative(Sink& out, const FormatSpec& spec,
+                               const char* s, std::size_t len)
+{
+    if (spec.spacePadPositive) {
+        // No truncation here; this just munges '+' into ' '.
+        TruncatingSink padOut(out, static_cast<std::size_t>(-1), true);
+        FormatSpec padSpec = spec;
+        padSpec.spacePadPositive = false;
+        return formatStringNative(padOut, padSpec, s, len);
+    }
+    if (spec.ntrunc >= 0)
+        len = (std::min)(len, static_cast<std::size_t>(spec.ntrunc));
+    writePadded(out, spec, spec.fill, s, len);
+    return true;
+}
+
+// Write the first n bytes of `bytes` as hex digit pairs, with separators.
+inline void writeHexBytes(Sink& out, const HexBytes& bytes, std::size_t n,
+                          bool upper)
+{
+    const char* pairs = upper ? DigitPairs<0>::hexUpper : DigitPairs<0>::hexLower;
+    const std::size_t groupSize = bytes.groupSize != 0 ? bytes.groupSize : n;
+    // Encode into a local buffer in chunks, leaving room for a separator
+    // and a digit pair at the end of each chunk.
+    char buf[nativeBufSize];
+    char* p = buf;
+    std::size_t inGroup = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (inGroup == groupSize) {
+            *p++ = bytes.separator;
+            inGroup = 0;
+        }
+        const char* pair = pairs + 2*bytes.data[i];
+        p[0] = pair[0];
+        p[1] = pair[1];
+        p += 2;
+        ++inGroup;
+        if (p > buf + nativeBufSize - 3) {
+            out.append(buf, static_cast<std::size_t>(p - buf));
+            p = buf;
+        }
+    }
+    out.append(buf, static_cast<std::size_t>(p - buf));
+}
+
+inline void formatHexBytesNative(Sink& out, const FormatSpec& spec,
+                                 const HexBytes& bytes)
+{
+    std::size_t n = bytes.size;
+    if (spec.precisionSet)
+        n = (std::min)(n, static_cast<std::size_t>(spec.precision));
+    std::size_t len = 2*n;
+    if (n != 0 && bytes.groupSize != 0)
+        len += (n - 1)/bytes.groupSize;
+    // Integer conversions without a width use the precision as the width,
+    // which doesn't apply here.
+    const std::size_t width = spec.widthSet ? static_cast<std::size_t>(spec.width) : 0;
+    const std::size_t npad = width > len ? width - len : 0;
+    const bool left = (spec.flags & FormatSpec::Left) != 0;
+    out.reserve(len + npad);
+    if (!left)
+        out.fill(spec.fill, npad);
+    writeHexBytes(out, bytes, n, spec.conv == 'X');
+    if (left)
+        out.fill(spec.fill, npad);
+}
+
+// Format built-in argument types directly from the parsed spec, bypassing
+// formatValue() and the stream formatting machinery.  Numeric types are only
+// handled if `numerics` is true, since their stream formatting depends on
+// the locale.  Returns false if the argument must be formatted via the
+// stream instead.
+inline bool formatBuiltin(Sink& out, const FormatSpec& spec,
+                          const FormatArg& arg, bool numerics)
+{
+    const void* value = arg.value();
+    const char conv = spec.conv;
+    switch (arg.type()) {
+        case ArgOther:
+            return false;
+        case ArgSinkFormat: {
+            // The output is padded here rather than by tinyformatTo(), so
+            // collect it first if there's a field width.
+            FieldBuffer field;
+            Sink& fieldOut = spec.width > 0 ? static_cast<Sink&>(field) : out;
+            if (spec.ntrunc >= 0) {
+                TruncatingSink truncOut(fieldOut, static_cast<std::size_t>(spec.ntrunc), false);
+                arg.formatToSink(truncOut, spec);
+            }
+            else {
+                arg.formatToSink(fieldOut, spec);
+            }
+            if (spec.width > 0)
+                writeField(out, spec, field);
+            return true;
+        }
+        case ArgCString:
+        case ArgCharArray: {
+            const char* s = arg.type() == ArgCString ?
+                            *static_cast<const char* const*>(value) :
+                            static_cast<const char*>(value);
+            if (conv == 'p')
+                return numerics && formatPointerNative(out, spec, s);
+            if (!s)
+                return false;
+            if (spec.ntrunc >= 0) {
+                // Take care not to overread C strings in truncating
+                // conversions like "%.4s" where at most 4 characters may be
+                // read.
+                std::size_t len = 0;
+                while (len < static_cast<std::size_t>(spec.ntrunc) && s[len] != 0)
+                    ++len;
+                return formatStringNative(out, spec, s, len);
+            }
+            return formatStringNative(out, spec, s, std::strlen(s));
+        }
+        case ArgStdString: {
+            const std::string& s = *static_cast<const std::string*>(value);
+            return formatStringNative(out, spec, s.data(), s.size());
+        }
+        case ArgHexBytes:
+            formatHexBytesNative(out, spec, *static_cast<const HexBytes*>(value));
+            return true;
+        case ArgRange:
+            // The range applies the spec to each element itself
+            arg.formatToSink(out, spec);
+            return true;
+        case ArgChar:
+        case ArgSignedChar:
+        case ArgUnsignedChar: {
+            int i = 0;
+            char c = 0;
+            if (arg.type() == ArgChar) {
+                c = *static_cast<const char*>(value);
+                i = static_cast<int>(c);
+            }
+            else if (arg.type() == ArgSignedChar) {
+                c = static_cast<char>(*static_cast<const signed char*>(value));
+                i = static_cast<int>(*static_cast<const signed char*>(value));
+            }
+            else {
+                c = static_cast<char>(*static_cast<const unsigned char*>(value));
+                i = static_cast<int>(*static_cast<const unsigned char*>(value));
+            }
+            switch (conv) {
+                case 'u': case 'd': case 'i': case 'o': case 'X': case 'x':
+                    return numerics && formatIntNative<int, unsigned int>(out, spec, i, true);
+                default:
+                    formatCharNative(out, spec, spec.fill, c);
+                    return true;
+            }
+        }
+        default:
+            break;
+    }
+    if (!numerics)
+        return false;
+    if (spec.ntrunc >= 0) {
+        // Truncated numeric output ("%.3s" of a number) ignores the other
+        // flags, as the stream formatting truncates the output of a fresh
+        // stream, but is padded to the field width as for printf().
+        FieldBuffer field;
+        Sink& fieldOut = spec.width > 0 ? static_cast<Sink&>(field) : out;
+        TruncatingSink truncOut(fieldOut, static_cast<std::size_t>(spec.ntrunc),
+                                spec.spacePadPositive);
+        if (!formatBuiltin(truncOut, FormatSpec(), arg, numerics))
+            return false;
+        if (spec.width > 0)
+            writeField(out, spec, field);
+        return true;
+    }
+    switch (arg.type()) {
+        case ArgBool: {
+            const bool b = *static_cast<const bool*>(value);
+            if ((spec.flags & FormatSpec::BoolAlpha) && conv != 'c') {
+                writePadded(out, spec, spec.fill, b ? "true" : "false", b ? 4 : 5);
+                return true;
+            }
+            return formatIntNative<long, unsigned long>(out, spec, b, true);
+        }
+        case ArgShort:
+            return formatIntNative<short, unsigned short>(out, spec, *static_cast<const short*>(value), true);
+        case ArgUnsignedShort:
+            return formatIntNative<unsigned short, unsigned short>(out, spec, *static_cast<const unsigned short*>(value), false);
+        case ArgInt:
+            return formatIntNative<int, unsigned int>(out, spec, *static_cast<const int*>(value), true);
+        case ArgUnsignedInt:
+            return formatIntNative<unsigned int, unsigned int>(out, spec, *static_cast<const unsigned int*>(value), false);
+        case ArgLong:
+            return formatIntNative<long, unsigned long>(out, spec, *static_cast<const long*>(value), true);
+        case ArgUnsignedLong:
+            return formatIntNative<unsigned long, unsigned long>(out, spec, *static_cast<const unsigned long*>(value), false);
+        case ArgLongLong:
+            return formatIntNative<long long, unsigned long long>(out, spec, *static_cast<const long long*>(value), true);
+        case ArgUnsignedLongLong:
+            return formatIntNative<unsigned long long, unsigned long long>(out, spec, *static_cast<const unsigned long long*>(value), false);
+        case ArgFloat:
+            return formatFloatNative(out, spec, static_cast<double>(*static_cast<const float*>(value)));
+        case ArgDouble:
+            return formatFloatNative(out, spec, *static_cast<const double*>(value));
+        case ArgLongDouble:
+            return formatFloatNative(out, spec, *static_cast<const long double*>(value));
+        case ArgPointer:
+            return formatPointerNative(out, spec, *static_cast<const void* const*>(value));
+        default:
+            return false;
+    }
+}
+
+
+//------------------------------------------------------------------------------
+#ifndef TINYFORMAT_NO_IOSTREAM
+// Saves the formatting state of a stream, restoring it on destruction
+class StreamStateSaver
+{
+    public:
+        explicit StreamStateSaver(std::ostream& out)
+            : m_out(out),
+            m_width(out.width()),
+            m_precision(out.precision()),
+            m_flags(out.flags()),
+            m_fill(out.fill())
+        { }
+
+        ~StreamStateSaver()
+        {
+            m_out.width(m_width);
+            m_out.precision(m_precision);
+            m_out.flags(m_flags);
+            m_out.fill(m_fill);
+        }
+
+    private:
+        StreamStateSaver(const StreamStateSaver&);
+        StreamStateSaver& operator=(const StreamStateSaver&);
+
+        std::ostream& m_out;
+        std::streamsize m_width;
+        std::streamsize m_precision;
+        std::ios::fmtflags m_flags;
+        char m_fill;
+};
+#endif // TINYFORMAT_NO_IOSTREAM
+
+
+// Return whether built-in numeric types may be formatted natively into
+// `out`.  This is the case unless the stream has a non-classic locale which
+// may affect the way they're formatted.  Output to sinks without a stream
+// (out is null) is formatted as for a new stream, with the global locale.
+inline bool useNativeNumerics(const std::ostream* out)
+{
+#if defined(TINYFORMAT_USE_C_LOCALE) || defined(TINYFORMAT_NO_IOSTREAM)
+    (void)out;
+    return true;
+#else
+    return (out ? out->getloc() : std::locale()) == std::locale::classic();
+#endif
+}
+
+
+#ifndef TINYFORMAT_NO_IOSTREAM
+// Give a temporary stream the locale and format flags of `state`.  Unlike
+// copyfmt(), this leaves out the tie (which would flush the tied stream for
+// each argument), the exceptions mask and any copyfmt_event callbacks.
+inline void copyFormatState(std::ostream& tmp, const std::ostream& state)
+{
+    tmp.imbue(state.getloc());
+    tmp.flags(state.flags());
+    tmp.precision(state.precision());
+    tmp.fill(state.fill());
+}
+
+// Format an argument which isn't handled natively into the stream, via
+// formatValue().
+inline void formatArgumentToStream(std::ostream& out, const FormatSpec& spec,
+                                   const FormatArg& arg, const char* fmtBegin,
+                                   const char* fmtEnd)
+{
+    StreamStateSaver saver(out);
+    applyFormatSpec(out, spec);
+    if (!spec.spacePadPositive) {
+        arg.format(out, fmtBegin, fmtEnd, spec.ntrunc);
+    }
+    else {
+        // The following is a special case with no direct correspondence
+        // between stream formatting and the printf() behaviour.  Simulate
+        // it crudely by formatting with showpos through a stream buffer
+        // which munges '+' into ' ' on the way to the output.
+        SpacePadStreambuf padBuf(out);
+        std::ostream tmpStream(&padBuf);
+        tmpStream.copyfmt(out);
+        tmpStream.setf(std::ios::showpos);
+        arg.format(tmpStream, fmtBegin, fmtEnd, spec.ntrunc);
+    }
+}
+
+
+// Format a single argument into the sink according to a resolved spec.
+// [fmtBegin, fmtEnd) is the text of the conversion spec, as passed on to
+// user defined formatValue() overloads.
+inline void formatArgument(Sink& sink, const FormatSpec& spec,
+                           const FormatArg& arg, const char* fmtBegin,
+                           const char* fmtEnd, bool nativeNumerics)
+{
+#ifdef TINYFORMAT_HAS_LAZY
+    if (arg.type() == ArgLazy) {
+        formatArgument(sink, spec, arg.resolve(), fmtBegin, fmtEnd, nativeNumerics);
+        return;
+    }
+#endif
+    if (formatBuiltin(sink, spec, arg, nativeNumerics))
+        return;
+    if (spec.ntrunc >= 0 && spec.width > 0) {
+        // Stream formatting of truncated output ignores the width, so pad it
+        // here as for the built-in types.
+        FieldBuffer field;
+        SinkStreambuf fieldBuf(field);
+        std::ostream tmpStream(&fieldBuf);
+        if (const std::ostream* state = sink.localeStream())
+            copyFormatState(tmpStream, *state);
+        formatArgumentToStream(tmpStream, spec, arg, fmtBegin, fmtEnd);
+        writeField(sink, spec, field);
+        return;
+    }
+    // Only ask for the stream here, since a buffering sink must flush its
+    // output to get it.
+    if (std::ostream* stream = sink.ostream()) {
+        formatArgumentToStream(*stream, spec, arg, fmtBegin, fmtEnd);
+    }
+    else {
+        // A sink may have a stream for its locale and formatting state but
+        // not accept output through it
+        SinkStreambuf sinkBuf(sink);
+        std::ostream tmpStream(&sinkBuf);
+        if (const std::ostream* state = sink.localeStream())
+            copyFormatState(tmpStream, *state);
+        formatArgumentToStream(tmpStream, spec, arg, fmtBegin, fmtEnd);
+    }
+}
+#else
+// Format a single argument into the sink according to a resolved spec.
+// Without iostreams all arguments are built-in types, and the only ones
+// formatBuiltin() declines are null C strings, which produce no output.
+inline void formatArgument(Sink& sink, const FormatSpec& spec,
+                           const FormatArg& arg, const char* /*fmtBegin*/,
+                           const char* /*fmtEnd*/, bool nativeNumerics)
+{
+#ifdef TINYFORMAT_HAS_LAZY
+    if (arg.type() == ArgLazy) {
+        formatArgument(sink, spec, arg.resolve(), NULL, NULL, nativeNumerics);
+        return;
+    }
+#endif
+    formatBuiltin(sink, spec, arg, nativeNumerics);
+}
+#endif // TINYFORMAT_NO_IOSTREAM
+
+
+inline void formatImpl(Sink& sink, const char* fmt,
+                       const detail::FormatArg* args,
+                       int numArgs)
+{
+    const bool nativeNumerics = useNativeNumerics(sink.localeStream());
+
+    // "Positional mode" means all format specs should be of the form "%n$..."
+    // with `n` an integer. We detect this in `parseFormatSpec`.
+    bool positionalMode = false;
+    int argIndex = 0;
+    while (true) {
+        fmt = printFormatStringLiteral(sink, fmt);
+        if (*fmt == '\0') {
+            if (!positionalMode && argIndex < numArgs) {
+                TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
+            }
+            break;
+        }
+        FormatSpec spec;
+        const char* fmtEnd = parseFormatSpec(spec, positionalMode, fmt);
+        resolveFormatSpec(spec, args, argIndex, numArgs);
+        // NB: argIndex may be incremented by reading variable width/precision
+        // in `resolveFormatSpec`, so do the bounds check here.
+        if (argIndex >= numArgs) {
+            TINYFORMAT_ERROR("tinyformat: Too many conversion specifiers in format string");
+            return;
+        }
+        formatArgument(sink, spec, args[argIndex], fmt, fmtEnd, nativeNumerics);
+        if (!positionalMode)
+            ++argIndex;
+        fmt = fmtEnd;
+    }
+}
+
+struct FormatListAccess;
+
+} // namespace detail
+
+
+/// Range of elements to be formatted, as returned by range().
+///
+/// The conversion is applied to each element in turn, with the separator
+/// between elements and optional brackets around them all, so
+///
+///   tfm::format("%.2f", tfm::range(v).brackets("[", "]"))
+///
+/// gives "[1.00, 2.50, 3.14]".  The setters return the range for chaining.
+template<typename Iter>
+class Range
+{
+    public:
+        Range(Iter begin, Iter end)
+            : m_begin(begin), m_end(end), m_separator(", "), m_open(""),
+            m_close(""), m_limit(static_cast<std::size_t>(-1))
+        { }
+
+        /// Set the separator between elements, ", " by default
+        Range& separator(const char* sep) { m_separator = sep; return *this; }
+
+        /// Set text to surround the elements, such as "[" and "]"
+        Range& brackets(const char* open, const char* close)
+        {
+            m_open = open;
+            m_close = close;
+            return *this;
+        }
+
+        /// Show at most `n` elements, then "..." if there are more
+        Range& limit(std::size_t n) { m_limit = n; return *this; }
+
+        void format(Sink& out, const FormatSpec& spec) const
+        {
+            // Elements which can't be formatted natively are formatted as
+            // if the conversion spec consisted of just the conversion.
+            const char convSpec[2] = {'%', spec.conv};
+            const bool nativeNumerics = detail::useNativeNumerics(out.localeStream());
+            out.append(m_open, std::strlen(m_open));
+            const std::size_t sepLen = std::strlen(m_separator);
+            std::size_t count = 0;
+            for (Iter i = m_begin; i != m_end; ++i, ++count) {
+                if (count != 0)
+                    out.append(m_separator, sepLen);
+                if (count == m_limit) {
+                    out.append("...", 3);
+                    break;
+                }
+                detail::formatArgument(out, spec, detail::FormatArg(*i),
+                                       convSpec, convSpec + 2, nativeNumerics);
+            }
+            out.append(m_close, std::strlen(m_close));
+        }
+
+    private:
+        Iter m_begin;
+        Iter m_end;
+        const char* m_separator;
+        const char* m_open;
+        const char* m_close;
+        std::size_t m_limit;
+};
+
+template<typename Iter>
+inline void tinyformatTo(Sink& out, const FormatSpec& spec, const Range<Iter>& range)
+{
+    range.format(out, spec);
+}
+
+/// Wrap the elements [begin, end) for formatting; see Range
+template<typename Iter>
+inline Range<Iter> range(Iter begin, Iter end)
+{
+    return Range<Iter>(begin, end);
+}
+
+/// Wrap the elements of a container for formatting; see Range
+template<typename Container>
+inline Range<typename Container::const_iterator> range(const Container& c)
+{
+    return Range<typename Container::const_iterator>(c.begin(), c.end());
+}
+
+/// Wrap the elements of an array for formatting; see Range
+template<typename T, std::size_t n>
+inline Range<const T*> range(const T (&array)[n])
+{
+    return Range<const T*>(array, array + n);
+}
+
+
+#ifdef TINYFORMAT_HAS_LAZY
+/// Argument computed only when it's formatted, as returned by lazy().
+///
+/// The callable is invoked the first time the argument is formatted, and
+/// the result formatted as if it had been passed directly.  Later uses of
+/// the same argument, as in "%1$s ... %1$s", reuse the result.  A Lazy
+/// object isn't safe to format from several threads at once.
+template<typename F>
+class Lazy : private detail::LazyArg
+{
+    public:
+        typedef typename std::decay<decltype(std::declval<F&>()())>::type Result;
+
+        explicit Lazy(const F& func)
+            : LazyArg(&resolveImpl), m_func(func), m_evaluated(false)
+        { }
+
+        // Copies share the callable but not its result
+        Lazy(const Lazy& other)
+            : LazyArg(&resolveImpl), m_func(other.m_func), m_evaluated(false)
+        { }
+
+        ~Lazy()
+        {
+            if (m_evaluated)
+                m_result.value.~Result();
+        }
+
+    private:
+        friend class detail::FormatArg;
+
+        Lazy& operator=(const Lazy&);
+
+        static const detail::FormatArg& resolveImpl(const detail::LazyArg& arg)
+        {
+            const Lazy& self = static_cast<const Lazy&>(arg);
+            if (!self.m_evaluated) {
+                new (&self.m_result.value) Result(self.m_func());
+                self.m_evaluated = true;
+                self.m_arg = detail::FormatArg(self.m_result.value);
+            }
+            return self.m_arg;
+        }
+
+        // Storage for the result, constructed on evaluation
+        union Storage
+        {
+            Storage() { }
+            ~Storage() { }
+            Result value;
+        };
+
+        mutable F m_func;
+        mutable bool m_evaluated;
+        mutable Storage m_result;
+        mutable detail::FormatArg m_arg;
+};
+
+/// Wrap a callable taking no arguments, to be called only if and when the
+/// argument is formatted.  For example
+///
+///   tfm::printfln("state: %s", tfm::lazy([&]{ return dumpState(); }));
+template<typename F>
+inline Lazy<F> lazy(F func)
+{
+    return Lazy<F>(func);
+}
+#endif
+
+
+#ifndef TINYFORMAT_NO_IOSTREAM
+/// Stream output of hexbytes(), as for "%s"
+inline std::ostream& operator<<(std::ostream& out, const HexBytes& bytes)
+{
+    detail::FieldBuffer field;
+    detail::writeHexBytes(field, bytes, bytes.size, false);
+    out.write(field.data(), static_cast<std::streamsize>(field.size()));
+    return out;
+}
+#endif
+
+
+#ifdef TINYFORMAT_HAS_CHRONO
+/// Wall clock time to be formatted, as returned by timestamp()
+struct Timestamp
+{
+    std::chrono::system_clock::time_point time;
+    const char* pattern;
+    bool utc;
+};
+
+/// Wrap `time` for formatting with the strftime() pattern `pattern`, in UTC
+/// or local time.  The pattern may also contain one "%<n>f" for the first n
+/// digits of the fraction of a second (n = 1 to 9; six if omitted), so
+///
+///   tfm::printfln("%s %s", tfm::timestamp(now), message);
+///
+/// prints lines starting like "2023-11-14 22:13:20.123".  The strftime()
+/// output for the current second is cached per thread, so successive
+/// timestamps within a second only cost rendering the fraction digits.
+inline Timestamp timestamp(std::chrono::system_clock::time_point time,
+                           const char* pattern = "%Y-%m-%d %H:%M:%S.%3f",
+                           bool utc = false)
+{
+    Timestamp ts = {time, pattern, utc};
+    return ts;
+}
+
+namespace detail {
+
+// Timestamp formatter, caching the strftime() output for the most recently
+// formatted second.  The pattern is split around any fraction of a second
+// conversion, and the strftime() output of the head and tail is kept.
+class TimestampFormatter
+{
+    public:
+        TimestampFormatter() : m_utc(false), m_second(0), m_valid(false), m_fracDigits(0) { }
+
+        void format(Sink& out, const Timestamp& ts)
+        {
+            using namespace std::chrono;
+            const system_clock::duration sinceEpoch = ts.time.time_since_epoch();
+            seconds whole = duration_cast<seconds>(sinceEpoch);
+            if (whole > sinceEpoch)
+                whole -= seconds(1);  // Round towards the past, before 1970
+            const std::time_t second = static_cast<std::time_t>(whole.count());
+            if (!m_valid || m_second != second || m_utc != ts.utc || m_pattern != ts.pattern)
+                update(ts.pattern, ts.utc, second);
+            out.append(m_head.data(), m_head.size());
+            if (m_fracDigits > 0) {
+                long long frac = duration_cast<nanoseconds>(sinceEpoch - whole).count();
+                for (int i = m_fracDigits; i < 9; ++i)
+                    frac /= 10;
+                char digits[9];
+                for (int i = m_fracDigits - 1; i >= 0; --i, frac /= 10)
+                    digits[i] = static_cast<char>('0' + frac % 10);
+                out.append(digits, static_cast<std::size_t>(m_fracDigits));
+            }
+            out.append(m_tail.data(), m_tail.size());
+        }
+
+    private:
+        void update(const char* pattern, bool utc, std::time_t second)
+        {
+            if (!m_valid || m_utc != utc || m_pattern != pattern) {
+                m_pattern = pattern;
+                m_utc = utc;
+                splitPattern();
+            }
+            m_second = second;
+            std::tm tm;
+#ifdef _WIN32
+            if (utc)
+                gmtime_s(&tm, &second);
+            else
+                localtime_s(&tm, &second);
+#else
+            if (utc)
+                gmtime_r(&second, &tm);
+            else
+                localtime_r(&second, &tm);
+#endif
+            render(m_head, m_headPattern, tm);
+            render(m_tail, m_tailPattern, tm);
+            m_valid = true;
+        }
+
+        // Find the first "%f" or "%<n>f" which isn't part of "%%"
+        void splitPattern()
+        {
+            m_headPattern = m_pattern;
+            m_tailPattern.clear();
+            m_fracDigits = 0;
+            for (std::size_t i = 0; i + 1 < m_pattern.size(); ++i) {
+                if (m_pattern[i] != '%')
+                    continue;
+                std::size_t j = i + 1;
+                int digits = 6;
+                if (m_pattern[j] >= '1' && m_pattern[j] <= '9')
+                    digits = m_pattern[j++] - '0';
+                if (j < m_pattern.size() && m_pattern[j] == 'f') {
+                    m_headPattern.assign(m_pattern, 0, i);
+                    m_tailPattern.assign(m_pattern, j + 1, std::string::npos);
+                    m_fracDigits = digits;
+                    return;
+                }
+                if (m_pattern[i+1] == '%')
+                    ++i;
+            }
+        }
+
+        static void render(std::string& out, const std::string& pattern, const std::tm& tm)
+        {
+            out.clear();
+            if (pattern.empty())
+                return;
+            char buf[256];
+            std::size_t len = std::strftime(buf, sizeof(buf), pattern.c_str(), &tm);
+            if (len != 0) {
+                out.assign(buf, len);
+                return;
+            }
+            // strftime() returns zero both when the output doesn't fit and
+            // when it's empty (as "%p" is in some locales), so retry with a
+            // larger buffer until it's more than any conversion could need.
+            const std::size_t maxSize = 64*pattern.size() + sizeof(buf);
+            for (std::size_t size = 2*sizeof(buf); len == 0 && size < 2*maxSize; size *= 2) {
+                out.resize((std::min)(size, maxSize));
+                len = std::strftime(&out[0], out.size(), pattern.c_str(), &tm);
+            }
+            out.resize(len);
+        }
+
+        std::string m_pattern;
+        bool m_utc;
+        std::time_t m_second;
+        bool m_valid;
+        std::string m_headPattern;
+        std::string m_tailPattern;
+        int m_fracDigits;
+        std::string m_head;
+        std::string m_tail;
+};
+
+} // namespace detail
+
+/// Format a timestamp; see timestamp()
+inline void tinyformatTo(Sink& out, const FormatSpec& /*spec*/, const Timestamp& ts)
+{
+    static thread_local detail::TimestampFormatter formatter;
+    formatter.format(out, ts);
+}
+#endif // TINYFORMAT_HAS_CHRONO
+
+
+/// List of template arguments format(), held in a type-opaque way.
+///
+/// A const reference to FormatList (typedef'd as FormatListRef) may be
+/// conveniently used to pass arguments to non-template functions: All type
+/// information has been stripped from the arguments, leaving just enough of a
+/// common interface to perform formatting as required.
+class FormatList
+{
+    public:
+        FormatList(detail::FormatArg* args, int N)
+            : m_args(args), m_N(N) { }
+
+        friend struct detail::FormatListAccess;
+
+    protected:
+        // Point the list at a different array, for lists built at runtime
+        void setArgs(const detail::FormatArg* args, int N) { m_args = args; m_N = N; }
+
+    private:
+        const detail::FormatArg* m_args;
+        int m_N;
+};
+
+/// Reference to type-opaque format list for passing to vformat()
+typedef const FormatList& FormatListRef;
+
+
+namespace detail {
+
+// Access to the arguments held in a FormatList, for formatting functions
+// other than vformat()
+struct FormatListAccess
+{
+    static const FormatArg* args(const FormatList& list) { return list.m_args; }
+    static int size(const FormatList& list) { return list.m_N; }
+};
+
+// Return a cheap estimate of the length of the formatted output, for
+// presizing string results: the length of the format string and any
+// std::string arguments, plus a few characters for each other argument.
+// C strings aren't measured, as they needn't be NUL terminated when used
+// with truncating conversions like "%.4s".
+inline std::size_t estimateFormattedSize(const char* fmt, const FormatList& list)
+{
+    std::size_t size = std::strlen(fmt);
+    const FormatArg* args = FormatListAccess::args(list);
+    for (int i = 0; i < FormatListAccess::size(list); ++i) {
+        if (args[i].type() == ArgStdString)
+            size += static_cast<const std::string*>(args[i].value())->size();
+        else
+            size += 4;
+    }
+    return size;
+}
+
+// Format list subclass with fixed storage to avoid dynamic allocation
+template<std::size_t N>
+class FormatListN : public FormatList
+{
+    public:
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+        template<typename... Args>
+        FormatListN(const Args&... args)
+            : FormatList(&m_formatterStore[0], N),
+            m_formatterStore { FormatArg(args)... }
+        { static_assert(sizeof...(args) == N, "Number of args must be N"); }
+#else // C++98 version
+        void init(int) {}
+#       define TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR(n)                \
+                                                                        \
+        template<TINYFORMAT_ARGTYPES(n)>                                \
+        FormatListN(TINYFORMAT_VARARGS(n))                              \
+            : FormatList(&m_formatterStore[0], n)                       \
+        { TINYFORMAT_ASSERT(n == N); init(0, TINYFORMAT_PASSARGS(n)); } \
+                                                                        \
+        template<TINYFORMAT_ARGTYPES(n)>                                \
+        void init(int i, TINYFORMAT_VARARGS(n))                         \
+        {                                                               \
+            m_formatterStore[i] = FormatArg(v1);                        \
+            init(i+1 TINYFORMAT_PASSARGS_TAIL(n));                      \
+        }
+
+        TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR)
+#       undef TINYFORMAT_MAKE_FORMATLIST_CONSTRUCTOR
+#endif
+        FormatListN(const FormatListN& other)
+            : FormatList(&m_formatterStore[0], N)
+        { std::copy(&other.m_formatterStore[0], &other.m_formatterStore[N],
+                    &m_formatterStore[0]); }
+
+    private:
+        FormatArg m_formatterStore[N];
+};
+
+// Special 0-arg version - MSVC says zero-sized C array in struct is nonstandard
+template<> class FormatListN<0> : public FormatList
+{
+    public: FormatListN() : FormatList(0, 0) {}
+};
+
+// Memory pool holding copies of the arguments of a DynamicFormatList.
+//
+// Values are placement constructed in a chain of blocks and never move, so
+// FormatArgs may point at them.  clear() destroys the values but keeps the
+// blocks for reuse, so a pool which is cleared and refilled with similar
+// arguments stops allocating.
+class ArgPool
+{
+    public:
+        ArgPool() : m_first(0), m_current(0), m_used(0), m_cleanups(0) { }
+
+        ~ArgPool()
+        {
+            clear();
+            while (m_first) {
+                Block* next = m_first->next;
+                delete[] reinterpret_cast<MaxAlign*>(m_first);
+                m_first = next;
+            }
+        }
+
+        // Return a copy of `value` held in the pool
+        template<typename T>
+        const T& copy(const T& value)
+        {
+            T* result = new (allocate(sizeof(T), AlignOf<T>::value)) T(value);
+            // Types which may own resources need destroying on clear().
+            // Built-in numbers and pointers don't.
+            const ArgType type = ArgTypeOf<T>::value;
+            if (type < ArgBool || type > ArgCString) {
+                Cleanup* cleanup = new (allocate(sizeof(Cleanup))) Cleanup;
+                cleanup->destroy = &destroyImpl<T>;
+                cleanup->value = result;
+                cleanup->next = m_cleanups;
+                m_cleanups = cleanup;
+            }
+            return *result;
+        }
+
+        // Return a NUL terminated copy of the n characters at s
+        const char* copyString(const char* s, std::size_t n)
+        {
+            char* result = static_cast<char*>(allocate(n + 1));
+            std::memcpy(result, s, n);
+            result[n] = '\0';
+            return result;
+        }
+
+        // Destroy all values, keeping the memory for reuse
+        void clear()
+        {
+            for (Cleanup* c = m_cleanups; c; c = c->next)
+                c->destroy(c->value);
+            m_cleanups = 0;
+            m_current = m_first;
+            m_used = 0;
+        }
+
+    private:
+        ArgPool(const ArgPool&);
+        ArgPool& operator=(const ArgPool&);
+
+        // Type with the strictest alignment which arguments are likely to need
+        union MaxAlign { long double ld; long long ll; double d; void* p; void (*f)(); };
+
+        struct Block
+        {
+            Block* next;
+            std::size_t size;  // Bytes of storage following the header
+        };
+
+        struct Cleanup
+        {
+            void (*destroy)(void* value);
+            void* value;
+            Cleanup* next;
+        };
+
+        enum
+        {
+            // Size of the block header, rounded up to keep storage aligned
+            headerSize = (sizeof(Block) + sizeof(MaxAlign) - 1) / sizeof(MaxAlign) * sizeof(MaxAlign),
+            // Minimum storage per block
+            blockSize = 1024
+        };
+
+        // Alignment of T, without C++11 alignof
+        template<typename T>
+        struct AlignOf
+        {
+            struct Padded { char c; T value; };
+            enum { value = sizeof(Padded) - sizeof(T) };
+        };
+
+        template<typename T>
+        static void destroyImpl(void* value) { static_cast<T*>(value)->~T(); }
+
+        static char* storage(Block* block) { return reinterpret_cast<char*>(block) + headerSize; }
+
+        // Bytes to skip from `p` for storage aligned to `align`, which is a
+        // power of two.  This is zero unless the value is over-aligned.
+        static std::size_t padding(const char* p, std::size_t align)
+        {
+            return (align - reinterpret_cast<std::size_t>(p) % align) % align;
+        }
+
+        void* allocate(std::size_t size, std::size_t align = 1)
+        {
+            size = (size + sizeof(MaxAlign) - 1) / sizeof(MaxAlign) * sizeof(MaxAlign);
+            // Use the first block in the chain, from the current one on,
+            // with room for the value.
+            while (m_current && m_used + padding(storage(m_current) + m_used, align)
+                                + size > m_current->size) {
+                m_current = m_current->next;
+                m_used = 0;
+            }
+            if (!m_current) {
+                // Over-aligned values may need padding in a new block too
+                const std::size_t bytes = headerSize +
+                    (std::max)(size + align - 1, std::size_t(blockSize));
+                Block* block = reinterpret_cast<Block*>(
+                    new MaxAlign[(bytes + sizeof(MaxAlign) - 1) / sizeof(MaxAlign)]);
+                block->next = 0;
+                block->size = bytes - headerSize;
+                appendBlock(block);
+                m_current = block;
+                m_used = 0;
+            }
+            m_used += padding(storage(m_current) + m_used, align);
+            void* result = storage(m_current) + m_used;
+            m_used += size;
+            return result;
+        }
+
+        void appendBlock(Block* block)
+        {
+            if (!m_first) {
+                m_first = block;
+                return;
+            }
+            Block* last = m_first;
+            while (last->next)
+                last = last->next;
+            last->next = block;
+        }
+
+        Block* m_first;
+        Block* m_current;
+        // Bytes used in the current block
+        std::size_t m_used;
+        // Values to destroy on clear(), most recent first
+        Cleanup* m_cleanups;
+};
+
+} // namespace detail
+
+
+/// Argument list built at runtime, for formatting when the number and types
+/// of arguments aren't known at compile time:
+///
+///   tfm::DynamicFormatList args;
+///   for (std::size_t i = 0; i < values.size(); ++i)
+///       args.push(values[i]);
+///   tfm::vformat(std::cout, fmt, args);
+///
+/// push() copies each argument into storage owned by the list, which is
+/// kept for reuse by clear().  A list which is cleared and refilled stops
+/// allocating once it has grown to fit, and formats at the same speed as a
+/// list from makeFormatList().  Strings are copied as NUL terminated
+/// character arrays, and other types by their copy constructors.
+class DynamicFormatList : public FormatList
+{
+    public:
+        DynamicFormatList() : FormatList(0, 0), m_argStore(0), m_size(0), m_capacity(0) { }
+
+        ~DynamicFormatList() { delete[] m_argStore; }
+
+        /// Append a copy of `value` to the list
+        template<typename T>
+        DynamicFormatList& push(const T& value)
+        {
+            return pushArg(detail::FormatArg(m_pool.copy(value)));
+        }
+
+        DynamicFormatList& push(const char* s)
+        {
+            if (!s)
+                return pushArg(detail::FormatArg(m_pool.copy(s)));
+            return pushArg(detail::FormatArg(m_pool.copy(m_pool.copyString(s, std::strlen(s)))));
+        }
+
+        DynamicFormatList& push(char* s) { return push(static_cast<const char*>(s)); }
+
+        DynamicFormatList& push(const std::string& s)
+        {
+            return pushArg(detail::FormatArg(m_pool.copy(m_pool.copyString(s.data(), s.size()))));
+        }
+
+        /// Append a reference to `value`, which must outlive any use of the
+        /// list, without copying it
+        template<typename T>
+        DynamicFormatList& pushRef(const T& value)
+        {
+            return pushArg(detail::FormatArg(value));
+        }
+
+        /// Remove all arguments, keeping the storage for reuse
+        void clear()
+        {
+            m_pool.clear();
+            m_size = 0;
+            setArgs(m_argStore, 0);
+        }
+
+        /// Return the number of arguments in the list
+        int size() const { return m_size; }
+
+    private:
+        DynamicFormatList(const DynamicFormatList&);
+        DynamicFormatList& operator=(const DynamicFormatList&);
+
+        DynamicFormatList& pushArg(const detail::FormatArg& arg)
+        {
+            if (m_size == m_capacity) {
+                const int capacity = m_capacity == 0 ? 8 : 2*m_capacity;
+                detail::FormatArg* args = new detail::FormatArg[capacity];
+                std::copy(m_argStore, m_argStore + m_size, args);
+                delete[] m_argStore;
+                m_argStore = args;
+                m_capacity = capacity;
+            }
+            m_argStore[m_size++] = arg;
+            setArgs(m_argStore, m_size);
+            return *this;
+        }
+
+        detail::ArgPool m_pool;
+        detail::FormatArg* m_argStore;
+        int m_size;
+        int m_capacity;
+};
+
+
+//------------------------------------------------------------------------------
+// Primary API functions
+
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+
+/// Make type-agnostic format list from list of template arguments.
+///
+/// The exact return type of this function is an implementation detail and
+/// shouldn't be relied upon.  Instead it should be stored as a FormatListRef:
+///
+///   FormatListRef formatList = makeFormatList( /*...*/ );
+template<typename... Args>
+detail::FormatListN<sizeof...(Args)> makeFormatList(const Args&... args)
+{
+    return detail::FormatListN<sizeof...(args)>(args...);
+}
+
+#else // C++98 version
+
+inline detail::FormatListN<0> makeFormatList()
+{
+    return detail::FormatListN<0>();
+}
+#define TINYFORMAT_MAKE_MAKEFORMATLIST(n)                     \
+template<TINYFORMAT_ARGTYPES(n)>                              \
+detail::FormatListN<n> makeFormatList(TINYFORMAT_VARARGS(n))  \
+{                                                             \
+    return detail::FormatListN<n>(TINYFORMAT_PASSARGS(n));    \
+}
+TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_MAKEFORMATLIST)
+#undef TINYFORMAT_MAKE_MAKEFORMATLIST
+
+#endif
+
+/// Format list of arguments to the sink according to the given format string.
+///
+/// The name vformat() is chosen for the semantic similarity to vprintf(): the
+/// list of format arguments is held in a single function argument.
+inline void vformat(Sink& sink, const char* fmt, FormatListRef list)
+{
+    detail::formatImpl(sink, fmt, detail::FormatListAccess::args(list),
+                       detail::FormatListAccess::size(list));
+}
+
+/// Format list of arguments into the character buffer `buf` of size `bufSize`
+/// according to the given format string.
+///
+/// As with C99 snprintf(), output which doesn't fit is discarded and the
+/// result is NUL terminated unless bufSize is zero.  Returns the number of
+/// characters which would have been written given a sufficiently large
+/// buffer, not counting the terminating NUL.  This function doesn't allocate
+/// when formatting built-in types.
+inline std::size_t vformatTo(char* buf, std::size_t bufSize, const char* fmt,
+                             FormatListRef list)
+{
+    FixedBufferSink sink(buf, bufSize);
+    vformat(sink, fmt, list);
+    return sink.finish();
+}
+
+/// Format list of arguments according to the given format string, appending
+/// the result to `str`.
+///
+/// The output is written directly into `str`, so any custom allocator (such
+/// as a std::pmr::polymorphic_allocator) is used for all memory needed to
+/// hold the result.  Tinyformat doesn't allocate any other intermediate
+/// buffers when formatting built-in types.
+template<typename Traits, typename Alloc>
+void vformatTo(std::basic_string<char, Traits, Alloc>& str, const char* fmt,
+               FormatListRef list)
+{
+    BasicStringSink<std::basic_string<char, Traits, Alloc> > sink(str);
+    vformat(sink, fmt, list);
+}
+
+/// Return the number of characters which would be produced by formatting the
+/// list of arguments according to the given format string.  The output is
+/// counted without being stored anywhere.
+inline std::size_t vformattedSize(const char* fmt, FormatListRef list)
+{
+    detail::CountingSink sink;
+    vformat(sink, fmt, list);
+    return sink.count();
+}
+
+
+/// Formatter producing its output in a series of chunks, for streaming a
+/// message of any length through a fixed size buffer:
+///
+///   tfm::FormatListRef list = tfm::makeFormatList(name, bigValue);
+///   tfm::ChunkedFormatter formatter("%s: %s\n", list);
+///   char frame[1024];
+///   while (!formatter.done())
+///       send(frame, formatter.next(frame, sizeof(frame)));
+///
+/// Each call to next() continues exactly where the previous one stopped,
+/// even part way through an argument.  The format string and list must
+/// outlive the formatter.  An argument split between chunks is formatted
+/// again by the next call, with the part already produced skipped, so
+/// user defined formatting must give the same output each time; strings
+/// and other values written in one piece are skipped without copying.
+class ChunkedFormatter
+{
+    public:
+        ChunkedFormatter(const char* fmt, FormatListRef list)
+            : m_fmt(fmt), m_list(list), m_argIndex(0), m_positionalMode(false),
+            m_skip(0), m_done(false)
+        { }
+
+        /// Return whether all output has been produced
+        bool done() const { return m_done; }
+
+        /// Write the next part of the output to `buf`, returning the number
+        /// of characters written.  Less than bufSize characters are written
+        /// only at the end of the output (and the last call may write none).
+        std::size_t next(char* buf, std::size_t bufSize)
+        {
+            TINYFORMAT_ASSERT(bufSize > 0);
+            const detail::FormatArg* args = detail::FormatListAccess::args(m_list);
+            const int numArgs = detail::FormatListAccess::size(m_list);
+            const bool nativeNumerics = detail::useNativeNumerics(NULL);
+            detail::ChunkSink sink(buf, bufSize, m_skip);
+            // Output is made of pieces consisting of a literal and the
+            // following conversion, each of which is either produced in
+            // full, or partly and resumed by skipping the part produced.
+            while (!m_done && (!sink.full() || *m_fmt == '\0')) {
+                const std::size_t pieceStart = sink.size();
+                bool positionalMode = m_positionalMode;
+                int argIndex = m_argIndex;
+                const char* fmt = detail::printFormatStringLiteral(sink, m_fmt);
+                const char* fmtEnd = fmt;
+                if (*fmt == '\0') {
+                    if (!positionalMode && argIndex < numArgs) {
+                        TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
+                    }
+                }
+                else {
+                    detail::FormatSpec spec;
+                    fmtEnd = detail::parseFormatSpec(spec, positionalMode, fmt);
+                    detail::resolveFormatSpec(spec, args, argIndex, numArgs);
+                    if (argIndex >= numArgs) {
+                        TINYFORMAT_ERROR("tinyformat: Too many conversion specifiers in format string");
+                        fmtEnd = fmt + std::strlen(fmt);
+                    }
+                    else {
+                        detail::formatArgument(sink, spec, args[argIndex], fmt, fmtEnd, nativeNumerics);
+                        if (!positionalMode)
+                            ++argIndex;
+                    }
+                }
+                if (sink.dropped()) {
+                    m_skip += sink.size() - pieceStart;
+                    break;
+                }
+                m_skip = 0;
+                m_done = *fmt == '\0';
+                m_fmt = fmtEnd;
+                m_positionalMode = positionalMode;
+                m_argIndex = argIndex;
+            }
+            return sink.size();
+        }
+
+    private:
+        ChunkedFormatter(const ChunkedFormatter&);
+        ChunkedFormatter& operator=(const ChunkedFormatter&);
+
+        // Start of the next piece of output in the format string
+        const char* m_fmt;
+        const FormatList& m_list;
+        int m_argIndex;
+        bool m_positionalMode;
+        // Number of characters of the next piece already produced
+        std::size_t m_skip;
+        bool m_done;
+};
+
+
+namespace detail {
+
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+
+// Largest output length seen for one format string
+struct CapacityHintSlot
+{
+    std::atomic<const char*> fmt;
+    std::atomic<std::size_t> size;
+};
+
+// Table of capacity hints, using open addressing keyed by the address of the
+// format string.  Slots are claimed with a compare and swap and only freed
+// by resetCapacityHints(), and sizes only grow, so races between threads
+// can only make a hint less accurate.  The dummy template parameter allows the
+// table to live in the header.
+template<int dummy>
+struct CapacityHints
+{
+    static_assert((TINYFORMAT_CAPACITY_HINT_SLOTS & (TINYFORMAT_CAPACITY_HINT_SLOTS - 1)) == 0,
+                  "TINYFORMAT_CAPACITY_HINT_SLOTS must be a power of two");
+
+    static CapacityHintSlot slots[TINYFORMAT_CAPACITY_HINT_SLOTS];
+    // Number of calls which found no free slot for their format string
+    static std::atomic<unsigned long long> overflows;
+
+    // Return the slot for `fmt`, or null if there is none.  With `claim`, a
+    // free slot is taken for `fmt` if there is one within a few slots of
+    // its hash.
+    static CapacityHintSlot* find(const char* fmt, bool claim)
+    {
+        const int maxProbes = 8;
+        std::uintptr_t h = (reinterpret_cast<std::uintptr_t>(fmt) >> 3) * 2654435761u;
+        std::size_t index = static_cast<std::size_t>(h ^ (h >> 16));
+        for (int probe = 0; probe < maxProbes; ++probe) {
+            CapacityHintSlot& slot = slots[(index + probe) & (TINYFORMAT_CAPACITY_HINT_SLOTS - 1)];
+            const char* key = slot.fmt.load(std::memory_order_relaxed);
+            if (key == fmt)
+                return &slot;
+            if (key == 0 && claim &&
+                (slot.fmt.compare_exchange_strong(key, fmt, std::memory_order_relaxed) ||
+                 key == fmt))
+                return &slot;
+        }
+        if (claim)
+            overflows.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    // Raise the hint in `slot` to `size`, up to TINYFORMAT_CAPACITY_HINT_MAX
+    static void update(CapacityHintSlot& slot, std::size_t size)
+    {
+        if (size > TINYFORMAT_CAPACITY_HINT_MAX)
+            size = TINYFORMAT_CAPACITY_HINT_MAX;
+        std::size_t old = slot.size.load(std::memory_order_relaxed);
+        while (size > old &&
+               !slot.size.compare_exchange_weak(old, size, std::memory_order_relaxed))
+        { }
+    }
+};
+
+template<int dummy>
+CapacityHintSlot CapacityHints<dummy>::slots[TINYFORMAT_CAPACITY_HINT_SLOTS];
+
+template<int dummy>
+std::atomic<unsigned long long> CapacityHints<dummy>::overflows;
+
+#endif // TINYFORMAT_HAS_CAPACITY_HINTS
+
+// Format into the empty string `result`, first reserving enough space for
+// the estimated length of the output so that it's usually only allocated
+// once.  Small results are left to fit in any small string buffer.  With
+// capacity hints, the estimate is raised to the longest output seen before
+// for the same format string.
+template<typename StringT>
+void formatNewString(StringT& result, const char* fmt, FormatListRef list)
+{
+    std::size_t estimate = estimateFormattedSize(fmt, list);
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+    CapacityHintSlot* hint = CapacityHints<0>::find(fmt, true);
+    if (hint)
+        estimate = (std::max)(estimate, hint->size.load(std::memory_order_relaxed));
+#endif
+    if (estimate > result.capacity())
+        result.reserve(estimate);
+    vformatTo(result, fmt, list);
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+    if (hint)
+        CapacityHints<0>::update(*hint, result.size());
+#endif
+}
+
+} // namespace detail
+
+
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+
+/// Usage of the table of capacity hints kept with
+/// TINYFORMAT_USE_CAPACITY_HINTS
+struct CapacityHintStats
+{
+    // Number of slots in the table, TINYFORMAT_CAPACITY_HINT_SLOTS
+    std::size_t slots;
+    // Number of slots holding a hint for a format string
+    std::size_t used;
+    // Size in bytes of the table, which is allocated statically
+    std::size_t tableBytes;
+    // Number of format() calls which found no free slot for their format
+    // string, and so were formatted without a hint
+    unsigned long long overflows;
+};
+
+/// Return the current usage of the capacity hint table.  This is a snapshot
+/// which may be out of date if other threads are formatting.
+inline CapacityHintStats capacityHintStats()
+{
+    typedef detail::CapacityHints<0> Hints;
+    CapacityHintStats stats;
+    stats.slots = TINYFORMAT_CAPACITY_HINT_SLOTS;
+    stats.used = 0;
+    for (std::size_t i = 0; i < TINYFORMAT_CAPACITY_HINT_SLOTS; ++i) {
+        if (Hints::slots[i].fmt.load(std::memory_order_relaxed))
+            ++stats.used;
+    }
+    stats.tableBytes = sizeof(Hints::slots);
+    stats.overflows = Hints::overflows.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/// Return the number of characters reserved up front when formatting a
+/// string with `fmt`, or zero if there is no hint for it yet.
+inline std::size_t capacityHint(const char* fmt)
+{
+    detail::CapacityHintSlot* hint = detail::CapacityHints<0>::find(fmt, false);
+    return hint ? hint->size.load(std::memory_order_relaxed) : 0;
+}
+
+/// Forget all capacity hints and reset the overflow count, for example when
+/// the table has filled up with format strings built at runtime which are no
+/// longer used.
+inline void resetCapacityHints()
+{
+    typedef detail::CapacityHints<0> Hints;
+    for (std::size_t i = 0; i < TINYFORMAT_CAPACITY_HINT_SLOTS; ++i) {
+        Hints::slots[i].size.store(0, std::memory_order_relaxed);
+        Hints::slots[i].fmt.store(0, std::memory_order_relaxed);
+    }
+    Hints::overflows.store(0, std::memory_order_relaxed);
+}
+
+#endif // TINYFORMAT_HAS_CAPACITY_HINTS
+
+
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+
+/// Format list of arguments to the sink according to the given format string
+template<typename... Args>
+void format(Sink& sink, const char* fmt, const Args&... args)
+{
+    vformat(sink, fmt, makeFormatList(args...));
+}
+
+/// Format list of arguments according to the given format string and return
+/// the result as a string.
 template<typename... Args>
 std::string format(const char* fmt, const Args&... args)
 {
-    std::ostringstream oss;
-    format(oss, fmt, args...);
-    return oss.str();
+    std::string result;
+    detail::formatNewString(result, fmt, makeFormatList(args...));
+    return result;
+}
+
+/// Format list of arguments according to the given format string and return
+/// the result as a string using the given allocator:
+///
+///   std::pmr::string s = tfm::format(std::allocator_arg, arenaAllocator,
+///                                    "%s: %d", name, value);
+template<typename Alloc, typename... Args>
+std::basic_string<char, std::char_traits<char>, Alloc>
+format(std::allocator_arg_t, const Alloc& alloc, const char* fmt, const Args&... args)
+{
+    std::basic_string<char, std::char_traits<char>, Alloc> result(alloc);
+    detail::formatNewString(result, fmt, makeFormatList(args...));
+    return result;
+}
+
+#ifdef TINYFORMAT_HAS_PMR
+/// Format list of arguments according to the given format string and return
+/// the result as a std::pmr::string allocated from `resource`.
+template<typename... Args>
+std::pmr::string format(std::pmr::memory_resource* resource, const char* fmt,
+                        const Args&... args)
+{
+    std::pmr::string result(resource);
+    detail::formatNewString(result, fmt, makeFormatList(args...));
+    return result;
+}
+#endif
+
+/// Format list of arguments according to the given format string, appending
+/// the result to `str`; see vformatTo() for details.
+template<typename Traits, typename Alloc, typename... Args>
+void formatTo(std::basic_string<char, Traits, Alloc>& str, const char* fmt,
+              const Args&... args)
+{
+    vformatTo(str, fmt, makeFormatList(args...));
 }
 
-/// Format list of arguments to std::cout, according to the given format string
+/// Format list of arguments into the buffer `buf` of size `bufSize`; see
+/// vformatTo() for details.
 template<typename... Args>
-void printf(const char* fmt, const Args&... args)
+std::size_t formatTo(char* buf, std::size_t bufSize, const char* fmt, const Args&... args)
 {
-    format(std::cout, fmt, args...);
+    return vformatTo(buf, bufSize, fmt, makeFormatList(args...));
 }
 
+/// Return the number of characters which formatting the list of arguments
+/// would produce; see vformattedSize().
 template<typename... Args>
-void printfln(const char* fmt, const Args&... args)
+std::size_t formattedSize(const char* fmt, const Args&... args)
 {
-    format(std::cout, fmt, args...);
-    std::cout << '\n';
+    return vformattedSize(fmt, makeFormatList(args...));
 }
 
 
 #else // C++98 version
 
-inline void format(std::ostream& out, const char* fmt)
+inline void format(Sink& sink, const char* fmt)
 {
-    vformat(out, fmt, makeFormatList());
+    vformat(sink, fmt, makeFormatList());
 }
 
 inline std::string format(const char* fmt)
 {
-    std::ostringstream oss;
-    format(oss, fmt);
-    return oss.str();
+    std::string result;
+    detail::formatNewString(result, fmt, makeFormatList());
+    return result;
 }
 
-inline void printf(const char* fmt)
+inline std::size_t formatTo(char* buf, std::size_t bufSize, const char* fmt)
 {
-    format(std::cout, fmt);
+    return vformatTo(buf, bufSize, fmt, makeFormatList());
 }
 
-inline void printfln(const char* fmt)
+inline std::size_t formattedSize(const char* fmt)
 {
-    format(std::cout, fmt);
-    std::cout << '\n';
+    return vformattedSize(fmt, makeFormatList());
+}
+
+template<typename Traits, typename Alloc>
+void formatTo(std::basic_string<char, Traits, Alloc>& str, const char* fmt)
+{
+    vformatTo(str, fmt, makeFormatList());
 }
 
 #define TINYFORMAT_MAKE_FORMAT_FUNCS(n)                                   \
                                                                           \
 template<TINYFORMAT_ARGTYPES(n)>                                          \
-void format(std::ostream& out, const char* fmt, TINYFORMAT_VARARGS(n))    \
+void format(Sink& sink, const char* fmt, TINYFORMAT_VARARGS(n))           \
 {                                                                         \
-    vformat(out, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));            \
+    vformat(sink, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));           \
 }                                                                         \
                                                                           \
 template<TINYFORMAT_ARGTYPES(n)>                                          \
 std::string format(const char* fmt, TINYFORMAT_VARARGS(n))                \
 {                                                                         \
-    std::ostringstream oss;                                               \
-    format(oss, fmt, TINYFORMAT_PASSARGS(n));                             \
-    return oss.str();                                                     \
+    std::string result;                                                   \
+    detail::formatNewString(result, fmt,                                  \
+                            makeFormatList(TINYFORMAT_PASSARGS(n)));      \
+    return result;                                                        \
 }                                                                         \
                                                                           \
 template<TINYFORMAT_ARGTYPES(n)>                                          \
-void printf(const char* fmt, TINYFORMAT_VARARGS(n))                       \
+std::size_t formatTo(char* buf, std::size_t bufSize, const char* fmt,     \
+                     TINYFORMAT_VARARGS(n))                               \
 {                                                                         \
-    format(std::cout, fmt, TINYFORMAT_PASSARGS(n));                       \
+    return vformatTo(buf, bufSize, fmt,                                   \
+                     makeFormatList(TINYFORMAT_PASSARGS(n)));             \
 }                                                                         \
                                                                           \
 template<TINYFORMAT_ARGTYPES(n)>                                          \
-void printfln(const char* fmt, TINYFORMAT_VARARGS(n))                     \
+std::size_t formattedSize(const char* fmt, TINYFORMAT_VARARGS(n))         \
+{                                                                         \
+    return vformattedSize(fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));   \
+}                                                                         \
+                                                                          \
+template<class Traits, class Alloc, TINYFORMAT_ARGTYPES(n)>               \
+void formatTo(std::basic_string<char, Traits, Alloc>& str,                \
+              const char* fmt, TINYFORMAT_VARARGS(n))                     \
 {                                                                         \
-    format(std::cout, fmt, TINYFORMAT_PASSARGS(n));                       \
-    std::cout << '\n';                                                    \
+    vformatTo(str, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));          \
 }
 
 TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_FORMAT_FUNCS)
@@ -1161,4 +3874,8 @@ TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_FORMAT_FUNCS)
 
 } // namespace tinyformat
 
+#ifndef TINYFORMAT_NO_IOSTREAM
+#   include "tinyformat_ostream.h"
+#endif
+
 #endif // TINYFORMAT_H_INCLUDED
@@ -0,0 +1,276 @@
+// Test that the allocation-free subset of the tinyformat API really doesn't
+// allocate.  Global operator new is replaced with a counting version, and
+// each covered formatting call is checked both for the result and for the
+// number of allocations made while it ran.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <new>
+#include <string>
+
+// Covered by capacityHintTests(), and has no effect on the rest
+#define TINYFORMAT_USE_CAPACITY_HINTS
+#include "tinyformat.h"
+
+// This test is also built with TINYFORMAT_NO_IOSTREAM, so check that the
+// iostreams headers really are left out.
+#if defined(TINYFORMAT_NO_IOSTREAM) && \
+    (defined(_GLIBCXX_IOSTREAM) || defined(_GLIBCXX_OSTREAM) || defined(_LIBCPP_IOSTREAM))
+#   error "tinyformat.h included iostreams with TINYFORMAT_NO_IOSTREAM"
+#endif
+
+#if __cplusplus >= 201103L
+#   define TEST_THROW_BAD_ALLOC
+#   define TEST_NOTHROW noexcept
+#else
+#   define TEST_THROW_BAD_ALLOC throw(std::bad_alloc)
+#   define TEST_NOTHROW throw()
+#endif
+
+static bool g_countAllocs = false;
+static long g_numAllocs = 0;
+
+static void* countedAlloc(std::size_t size)
+{
+    if (g_countAllocs)
+        ++g_numAllocs;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size) TEST_THROW_BAD_ALLOC { return countedAlloc(size); }
+void* operator new[](std::size_t size) TEST_THROW_BAD_ALLOC { return countedAlloc(size); }
+void operator delete(void* p) TEST_NOTHROW { std::free(p); }
+void operator delete[](void* p) TEST_NOTHROW { std::free(p); }
+
+
+static char buf[128];
+
+// User defined type formatted natively with tinyformatTo()
+namespace test {
+struct Id { int value; };
+
+void tinyformatTo(tfm::Sink& out, const tfm::FormatSpec& /*spec*/, const Id& id)
+{
+    out.append("id-", 3);
+    out.put(static_cast<char>('0' + id.value % 10));
+}
+}
+
+#if defined(TINYFORMAT_NO_IOSTREAM) && defined(TEST_USER_TYPE_COMPILE)
+// Formatting user defined types requires iostreams, so should fail to compile
+struct UserType {};
+static std::size_t formatUserType()
+{
+    return tfm::formatTo(buf, sizeof(buf), "%s", UserType());
+}
+#endif
+
+// Format into buf and teeBuf at once through a TeeSink
+static char teeBuf[128];
+static std::size_t formatToTee(const char* s, int i)
+{
+    tfm::FixedBufferSink sink1(buf, sizeof(buf));
+    tfm::FixedBufferSink sink2(teeBuf, sizeof(teeBuf));
+    {
+        tfm::TeeSink tee(sink1, sink2);
+        tfm::format(tee, "%s:%5d", s, i);
+    }
+    sink2.finish();
+    return sink1.finish();
+}
+
+// Refill a reused runtime built argument list and format it
+static std::size_t formatDynamic(tfm::DynamicFormatList& args, int i)
+{
+    args.clear();
+    args.push(i).push("name").push(std::string("value")).push(2.5);
+    return tfm::vformatTo(buf, sizeof(buf), "%d %s=%s %.1f", args);
+}
+
+#define CHECK_NOALLOC(expected, expression)                                 \
+{                                                                           \
+    g_numAllocs = 0;                                                        \
+    g_countAllocs = true;                                                   \
+    std::size_t len = expression;                                           \
+    g_countAllocs = false;                                                  \
+    if (g_numAllocs != 0 || std::strcmp(buf, expected) != 0 ||             \
+        len != std::strlen(expected))                                       \
+    {                                                                       \
+        std::printf("test failed, line %d\n", __LINE__);                    \
+        std::printf("%ld allocations, result \"%s\" != \"%s\"\n",           \
+                    g_numAllocs, buf, expected);                            \
+        ++nfailed;                                                          \
+    }                                                                       \
+}
+
+
+int allocTests()
+{
+    int nfailed = 0;
+    std::string str("a std::string");
+    const char* cstr = "a C string";
+
+    // Standard library facets may allocate caches lazily on first use, so
+    // warm these up before counting.
+    tfm::formatTo(buf, sizeof(buf), "%d %f %s %p", 1, 1.0, true, (void*)0);
+
+    // Integers, with the common flags and widths
+    CHECK_NOALLOC("42", tfm::formatTo(buf, sizeof(buf), "%d", 42));
+    CHECK_NOALLOC("-000000010", tfm::formatTo(buf, sizeof(buf), "%010d", -10));
+    CHECK_NOALLOC("0X0000BEEF", tfm::formatTo(buf, sizeof(buf), "%#010X", 0xBEEF));
+    CHECK_NOALLOC("+3 0010 12", tfm::formatTo(buf, sizeof(buf), "%+d %.4d %o", 3, 10, 012));
+    CHECK_NOALLOC("9223372036854775807",
+                  tfm::formatTo(buf, sizeof(buf), "%lld", (long long)9223372036854775807LL));
+    CHECK_NOALLOC("4294967295 65535",
+                  tfm::formatTo(buf, sizeof(buf), "%u %hu", 4294967295u, (unsigned short)65535));
+    // Space padding of positive numbers
+    CHECK_NOALLOC(" 10 -10", tfm::formatTo(buf, sizeof(buf), "% d % d", 10, -10));
+    // Floating point
+    CHECK_NOALLOC("1.2340000000:+3.13:1.234560e+10",
+                  tfm::formatTo(buf, sizeof(buf), "%0.10f:%+g:%e", 1.234, 3.13, 1.23456e10));
+    CHECK_NOALLOC("  1.50", tfm::formatTo(buf, sizeof(buf), "%6.2f", 1.5f));
+    // Characters, bools and pointers
+    CHECK_NOALLOC("A 65 B", tfm::formatTo(buf, sizeof(buf), "%c %d %c", 'A', 'A', 66));
+    CHECK_NOALLOC("true 1", tfm::formatTo(buf, sizeof(buf), "%s %d", true, true));
+    CHECK_NOALLOC("0x12345", tfm::formatTo(buf, sizeof(buf), "%p", (void*)0x12345));
+    // Strings, including truncating conversions
+    CHECK_NOALLOC("a C string|a std::string",
+                  tfm::formatTo(buf, sizeof(buf), "%s|%s", cstr, str));
+    CHECK_NOALLOC("a C|a std", tfm::formatTo(buf, sizeof(buf), "%.3s|%.5s", cstr, str));
+    CHECK_NOALLOC("   a C|12  ", tfm::formatTo(buf, sizeof(buf), "%6.3s|%-4.2s", cstr, 123));
+    // User defined types with tinyformatTo()
+    test::Id id = {7};
+    CHECK_NOALLOC("[id-7]", tfm::formatTo(buf, sizeof(buf), "[%s]", id));
+    CHECK_NOALLOC("[  id-7]", tfm::formatTo(buf, sizeof(buf), "[%6s]", id));
+    // Byte ranges in hex
+    const unsigned char bytes[] = {0xde, 0xad, 0xbe, 0xef, 0x01};
+    CHECK_NOALLOC("de ad be|DEADBEEF01",
+                  tfm::formatTo(buf, sizeof(buf), "%.3s|%X", tfm::hexbytes(bytes, 5, 1),
+                                tfm::hexbytes(bytes, 5)));
+    // Ranges
+    const double values[] = {1.5, -2, 1e6};
+    CHECK_NOALLOC("[1.50, -2.00, ...]",
+                  tfm::formatTo(buf, sizeof(buf), "%.2f", tfm::range(values).brackets("[", "]").limit(2)));
+#ifdef TINYFORMAT_HAS_CHRONO
+    // Timestamps, once the per-thread cache has been set up
+    std::chrono::system_clock::time_point t = std::chrono::system_clock::from_time_t(1700000000);
+    tfm::formatTo(buf, sizeof(buf), "%s", tfm::timestamp(t, "%Y-%m-%d %H:%M:%S.%3f", true));
+    CHECK_NOALLOC("2023-11-14 22:13:20.042 x",
+                  tfm::formatTo(buf, sizeof(buf), "%s %s", tfm::timestamp(
+                      t + std::chrono::milliseconds(42), "%Y-%m-%d %H:%M:%S.%3f", true), "x"));
+#endif
+#ifdef TINYFORMAT_HAS_LAZY
+    // Lazy arguments
+    CHECK_NOALLOC("7 7", tfm::formatTo(buf, sizeof(buf), "%1$d %1$d", tfm::lazy([]{ return 7; })));
+#endif
+    // Output to several sinks
+    CHECK_NOALLOC("ab:   42", formatToTee("ab", 42));
+    if (std::strcmp(teeBuf, "ab:   42") != 0) {
+        std::printf("test failed, line %d\n", __LINE__);
+        ++nfailed;
+    }
+    // Argument lists built at runtime, once their storage has grown
+    tfm::DynamicFormatList dynArgs;
+    formatDynamic(dynArgs, 0);
+    CHECK_NOALLOC("7 name=value 2.5", formatDynamic(dynArgs, 7));
+    // Variable width and positional arguments
+    CHECK_NOALLOC("   -10|20 10",
+                  tfm::formatTo(buf, sizeof(buf), "%*d|%s", 6, -10, "20 10"));
+    CHECK_NOALLOC("20 10", tfm::formatTo(buf, sizeof(buf), "%2$d %1$d", 10, 20));
+    // Output larger than the buffer is truncated, but the full length is
+    // still reported.
+    CHECK_NOALLOC("0123", tfm::formatTo(buf, 5, "%s%d", "0123", 456789) - 6);
+
+    // Appending to a std::string with enough capacity doesn't allocate
+    std::string result;
+    result.reserve(100);
+    g_numAllocs = 0;
+    g_countAllocs = true;
+    tfm::formatTo(result, "%s:%d:%.2f:%.4s", cstr, 42, 1.5, str);
+    g_countAllocs = false;
+    if (g_numAllocs != 0 || result != "a C string:42:1.50:a st") {
+        std::printf("test failed, line %d\n", __LINE__);
+        std::printf("%ld allocations, result \"%s\"\n", g_numAllocs, result.c_str());
+        ++nfailed;
+    }
+
+    return nfailed;
+}
+
+
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+// Format a string whose length the initial estimate misses, returning the
+// number of allocations made
+static long countFormatAllocs(const char* fmt, const char* s1, const char* s2)
+{
+    g_numAllocs = 0;
+    g_countAllocs = true;
+    std::string result = tfm::format(fmt, s1, s2);
+    g_countAllocs = false;
+    return g_numAllocs;
+}
+
+int capacityHintTests()
+{
+    int nfailed = 0;
+    // C strings aren't included in the estimate, so without a hint this
+    // result is grown several times
+    std::string s1(100, 'a'), s2(200, 'b');
+    const char* fmt = "%s and %s";
+    long firstAllocs = countFormatAllocs(fmt, s1.c_str(), s2.c_str());
+    long laterAllocs = countFormatAllocs(fmt, s1.c_str(), s2.c_str());
+    // Shorter output at the same call site keeps the high-water mark
+    long shorterAllocs = countFormatAllocs(fmt, "x", "y");
+    if (firstAllocs < 2 || laterAllocs != 1 || shorterAllocs != 1 ||
+        tfm::capacityHint(fmt) != 305)
+    {
+        std::printf("test failed, line %d\n", __LINE__);
+        std::printf("allocations %ld, %ld, %ld, hint %d\n", firstAllocs,
+                    laterAllocs, shorterAllocs, (int)tfm::capacityHint(fmt));
+        ++nfailed;
+    }
+
+    // Fill the table with distinct format strings, which is counted as
+    // overflow rather than growing the table
+    static char fmts[2*TINYFORMAT_CAPACITY_HINT_SLOTS][4];
+    for (int i = 0; i < 2*TINYFORMAT_CAPACITY_HINT_SLOTS; ++i) {
+        std::strcpy(fmts[i], "%s");
+        tfm::format(fmts[i], "x");
+    }
+    tfm::CapacityHintStats stats = tfm::capacityHintStats();
+    if (stats.slots != TINYFORMAT_CAPACITY_HINT_SLOTS || stats.used <= stats.slots/2 ||
+        stats.used > stats.slots || stats.overflows == 0 ||
+        stats.tableBytes > 32*TINYFORMAT_CAPACITY_HINT_SLOTS)
+    {
+        std::printf("test failed, line %d\n", __LINE__);
+        std::printf("slots %d, used %d, bytes %d, overflows %d\n", (int)stats.slots,
+                    (int)stats.used, (int)stats.tableBytes, (int)stats.overflows);
+        ++nfailed;
+    }
+
+    tfm::resetCapacityHints();
+    stats = tfm::capacityHintStats();
+    if (stats.used != 0 || stats.overflows != 0 || tfm::capacityHint(fmt) != 0) {
+        std::printf("test failed, line %d\n", __LINE__);
+        ++nfailed;
+    }
+    return nfailed;
+}
+#endif
+
+
+int main()
+{
+    int nfailed = allocTests();
+#ifdef TINYFORMAT_HAS_CAPACITY_HINTS
+    nfailed += capacityHintTests();
+#endif
+    if (nfailed != 0)
+        std::printf("%d allocation tests failed\n", nfailed);
+    return nfailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,643 @@
+// tinyformat_catalog.h
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// Pre-parsed format strings and format string catalogs
+//
+// Format strings which are only known at runtime - typically translated
+// messages loaded at startup - can't be checked by the compiler, and a bad
+// one only shows up when it's used.  This optional companion to tinyformat.h
+// parses and validates such strings once, up front:
+//
+//   tfm::FormatCatalog catalog;
+//   // Messages with key "greeting" take a string and an integer
+//   catalog.declare("greeting", "sd");
+//   std::string errors;
+//   if (!catalog.loadFile("messages_de.txt", &errors))
+//       std::cerr << errors;  // Bad entries are skipped
+//   ...
+//   if (const tfm::ParsedFormat* greeting = catalog.find("greeting"))
+//       tfm::format(std::cout, *greeting, name, numMessages);
+//
+// The catalog file has one message per line in the form "key = format",
+// where the format may use the escapes \n, \t and \\.  Blank lines and lines
+// starting with '#' are ignored.
+//
+// Each format is checked for the errors which would otherwise be reported by
+// TINYFORMAT_ERROR at format time: unterminated conversions, %n and mixing of
+// positional and non-positional arguments.  If a signature was declared for
+// the key, every argument must also be used, and only with a conversion
+// compatible with the declared one.  Formatting with the resulting
+// ParsedFormat handle skips parsing of the format string entirely.
+//
+// A FixedLayout is parsed in the same way, but renders its literal text once
+// and then formats values into individual fixed width fields in place.
+
+#ifndef TINYFORMAT_CATALOG_H_INCLUDED
+#define TINYFORMAT_CATALOG_H_INCLUDED
+
+#include "tinyformat.h"
+
+#include <cctype>
+#include <map>
+#include <vector>
+
+namespace tinyformat {
+
+class ParsedFormat;
+inline void vformat(Sink& sink, const ParsedFormat& fmt, FormatListRef list);
+
+namespace detail {
+
+// Return the class of conversion `conv`: 'd' for integers and characters, 'f'
+// for floating point, 'p' for pointers and 's' for strings.  Returns '\0' if
+// conv isn't a valid conversion character.
+inline char conversionClass(char conv)
+{
+    switch (conv) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            return 'd';
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+        case 'a': case 'A':
+            return 'f';
+        case 'p':
+            return 'p';
+        case 's':
+            return 's';
+        default:
+            return '\0';
+    }
+}
+
+} // namespace detail
+
+
+/// A format string which has been parsed and validated ahead of time.
+///
+/// Formatting with a ParsedFormat gives the same output as formatting with
+/// the original string, without parsing the conversion specs each time.
+/// A ParsedFormat is immutable once parsed, so may be shared between threads.
+class ParsedFormat
+{
+    public:
+        ParsedFormat() : m_tailBegin(0), m_numArgs(0), m_positional(false) { }
+
+        /// Parse and validate the format string `fmt`.
+        ///
+        /// If `signature` is non-null, it gives the conversion character
+        /// expected for each argument in turn (eg, "sd" for a string and an
+        /// integer).  Each argument must then be used by the format string,
+        /// with a conversion of the same class (integer, floating point,
+        /// string or pointer); "%s" is accepted for any argument.
+        ///
+        /// Returns false and stores a message in `error` (if non-null) if the
+        /// format string is invalid, in which case *this is left unchanged.
+        bool parse(const std::string& fmt, const char* signature = 0,
+                   std::string* error = 0);
+
+        /// Return the original format string
+        const std::string& str() const { return m_fmt; }
+
+        /// Return the number of arguments used by the format string
+        int numArgs() const { return m_numArgs; }
+
+    private:
+        friend void vformat(Sink& sink, const ParsedFormat& fmt,
+                            FormatListRef list);
+
+        // Literal text followed by a conversion spec
+        struct Segment
+        {
+            // Range of literal text in m_literals
+            std::size_t literalBegin;
+            std::size_t literalEnd;
+            // Range of conversion spec text in m_fmt
+            std::size_t specBegin;
+            std::size_t specEnd;
+            detail::FormatSpec spec;
+        };
+
+        void formatImpl(Sink& sink, const detail::FormatArg* args,
+                        int numArgs) const;
+
+        std::string m_fmt;
+        // Literal text of the format string, with "%%" replaced by '%'
+        std::string m_literals;
+        std::vector<Segment> m_segments;
+        // Start of literal text following the last conversion
+        std::size_t m_tailBegin;
+        int m_numArgs;
+        bool m_positional;
+};
+
+
+inline bool ParsedFormat::parse(const std::string& fmt, const char* signature,
+                                std::string* error)
+{
+    ParsedFormat result;
+    result.m_fmt = fmt;
+    const char* fmtBegin = result.m_fmt.c_str();
+    const int numDeclared = signature ? (int)std::strlen(signature) : 0;
+    // Whether each argument has been used
+    std::vector<bool> used(numDeclared, false);
+    bool positionalMode = false;
+    bool sequentialMode = false;
+    int nextArg = 0;
+    const char* c = fmtBegin;
+    while (true) {
+        // Collect literal text up to the next conversion spec
+        std::size_t literalBegin = result.m_literals.size();
+        c = detail::appendFormatStringLiteral(result.m_literals, c);
+        if (*c == '\0') {
+            result.m_tailBegin = literalBegin;
+            break;
+        }
+        Segment seg;
+        seg.literalBegin = literalBegin;
+        seg.literalEnd = result.m_literals.size();
+        seg.specBegin = c - fmtBegin;
+        const char* parseError = 0;
+        c = detail::parseFormatSpec(seg.spec, positionalMode, c, &parseError);
+        if (!c)
+            return detail::setError(error, parseError);
+        seg.specEnd = c - fmtBegin;
+        if (positionalMode && sequentialMode)
+            return detail::setError(error, "tinyformat: Positional argument used after a non-positional one");
+        sequentialMode = !positionalMode;
+        const char conv = seg.spec.conv;
+        if (!detail::conversionClass(conv))
+            return detail::setError(error, format("tinyformat: Unknown conversion '%%%c'", conv));
+        // Check the arguments referenced by this conversion, in the order in
+        // which they're consumed.
+        const int refs[3] = { seg.spec.widthArg, seg.spec.precisionArg,
+                              seg.spec.argIndex };
+        for (int i = 0; i < 3; ++i) {
+            int ref = refs[i];
+            if (ref == detail::FormatSpec::NoArg)
+                continue;
+            int argIndex = (ref == detail::FormatSpec::NextArg) ? nextArg++ : ref;
+            if (argIndex >= result.m_numArgs)
+                result.m_numArgs = argIndex + 1;
+            if (!signature)
+                continue;
+            if (argIndex >= numDeclared) {
+                return detail::setError(error, format("tinyformat: Format uses argument %d, "
+                                          "but only %d are declared",
+                                          argIndex + 1, numDeclared));
+            }
+            // Variable width and precision must be integers
+            char usedAs = (i < 2) ? 'd' : conv;
+            char declared = signature[argIndex];
+            char usedClass = detail::conversionClass(usedAs);
+            if (usedClass != detail::conversionClass(declared) && usedClass != 's') {
+                return detail::setError(error, format("tinyformat: Argument %d is used as '%s' "
+                                          "but declared as '%%%c'", argIndex + 1,
+                                          std::string(fmt, seg.specBegin,
+                                                      seg.specEnd - seg.specBegin),
+                                          declared));
+            }
+            used[argIndex] = true;
+        }
+        result.m_segments.push_back(seg);
+    }
+    for (int i = 0; i < numDeclared; ++i) {
+        if (!used[i])
+            return detail::setError(error, format("tinyformat: Argument %d is not used", i + 1));
+    }
+    result.m_positional = positionalMode;
+    *this = result;
+    return true;
+}
+
+
+inline void ParsedFormat::formatImpl(Sink& sink, const detail::FormatArg* args,
+                                     int numArgs) const
+{
+    const bool nativeNumerics = detail::useNativeNumerics(sink.localeStream());
+    const char* fmt = m_fmt.c_str();
+    const char* literals = m_literals.data();
+    int argIndex = 0;
+    for (std::size_t i = 0; i < m_segments.size(); ++i) {
+        const Segment& seg = m_segments[i];
+        sink.append(literals + seg.literalBegin, seg.literalEnd - seg.literalBegin);
+        detail::FormatSpec spec = seg.spec;
+        detail::resolveFormatSpec(spec, args, argIndex, numArgs);
+        if (argIndex >= numArgs) {
+            TINYFORMAT_ERROR("tinyformat: Too many conversion specifiers in format string");
+            return;
+        }
+        detail::formatArgument(sink, spec, args[argIndex], fmt + seg.specBegin,
+                               fmt + seg.specEnd, nativeNumerics);
+        if (!m_positional)
+            ++argIndex;
+    }
+    sink.append(literals + m_tailBegin, m_literals.size() - m_tailBegin);
+    if (!m_positional && argIndex < numArgs) {
+        TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
+    }
+}
+
+
+/// Format list of arguments to the sink according to a pre-parsed format
+inline void vformat(Sink& sink, const ParsedFormat& fmt, FormatListRef list)
+{
+    fmt.formatImpl(sink, detail::FormatListAccess::args(list),
+                   detail::FormatListAccess::size(list));
+}
+
+#ifndef TINYFORMAT_NO_IOSTREAM
+/// Format list of arguments to the stream according to a pre-parsed format
+inline void vformat(std::ostream& out, const ParsedFormat& fmt, FormatListRef list)
+{
+    OstreamSink sink(out);
+    vformat(sink, fmt, list);
+    sink.flush();
+}
+#endif
+
+/// Format list of arguments according to a pre-parsed format, appending the
+/// result to `str`
+template<typename Traits, typename Alloc>
+void vformatTo(std::basic_string<char, Traits, Alloc>& str,
+               const ParsedFormat& fmt, FormatListRef list)
+{
+    BasicStringSink<std::basic_string<char, Traits, Alloc> > sink(str);
+    vformat(sink, fmt, list);
+}
+
+
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+
+#ifndef TINYFORMAT_NO_IOSTREAM
+/// Format list of arguments to the stream according to a pre-parsed format
+template<typename... Args>
+void format(std::ostream& out, const ParsedFormat& fmt, const Args&... args)
+{
+    vformat(out, fmt, makeFormatList(args...));
+}
+#endif
+
+/// Format list of arguments to the sink according to a pre-parsed format
+template<typename... Args>
+void format(Sink& sink, const ParsedFormat& fmt, const Args&... args)
+{
+    vformat(sink, fmt, makeFormatList(args...));
+}
+
+/// Format list of arguments according to a pre-parsed format and return the
+/// result as a string
+template<typename... Args>
+std::string format(const ParsedFormat& fmt, const Args&... args)
+{
+    std::string result;
+    vformatTo(result, fmt, makeFormatList(args...));
+    return result;
+}
+
+#else // C++98 version
+
+#ifndef TINYFORMAT_NO_IOSTREAM
+inline void format(std::ostream& out, const ParsedFormat& fmt)
+{
+    vformat(out, fmt, makeFormatList());
+}
+
+#define TINYFORMAT_MAKE_PARSED_FORMAT_OSTREAM_FUNCS(n)                      \
+                                                                            \
+template<TINYFORMAT_ARGTYPES(n)>                                            \
+void format(std::ostream& out, const ParsedFormat& fmt,                     \
+            TINYFORMAT_VARARGS(n))                                          \
+{                                                                           \
+    vformat(out, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));              \
+}
+
+TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_PARSED_FORMAT_OSTREAM_FUNCS)
+#undef TINYFORMAT_MAKE_PARSED_FORMAT_OSTREAM_FUNCS
+#endif
+
+inline void format(Sink& sink, const ParsedFormat& fmt)
+{
+    vformat(sink, fmt, makeFormatList());
+}
+
+inline std::string format(const ParsedFormat& fmt)
+{
+    std::string result;
+    vformatTo(result, fmt, makeFormatList());
+    return result;
+}
+
+#define TINYFORMAT_MAKE_PARSED_FORMAT_FUNCS(n)                              \
+                                                                            \
+template<TINYFORMAT_ARGTYPES(n)>                                            \
+void format(Sink& sink, const ParsedFormat& fmt, TINYFORMAT_VARARGS(n))     \
+{                                                                           \
+    vformat(sink, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));             \
+}                                                                           \
+                                                                            \
+template<TINYFORMAT_ARGTYPES(n)>                                            \
+std::string format(const ParsedFormat& fmt, TINYFORMAT_VARARGS(n))          \
+{                                                                           \
+    std::string result;                                                     \
+    vformatTo(result, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));         \
+    return result;                                                          \
+}
+
+TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_PARSED_FORMAT_FUNCS)
+#undef TINYFORMAT_MAKE_PARSED_FORMAT_FUNCS
+
+#endif
+
+
+/// A line with a fixed layout which is rendered once and then updated in
+/// place, for status lines and tickers where only a few fields change:
+///
+///   tfm::FixedLayout status;
+///   status.parse("BTC %10.2f  vol %8d  %-6.6s");
+///   status.set(0, price);   // Rewrites just the ten characters of slot 0
+///   write(1, status.data(), status.size());
+///
+/// Every conversion must have a literal width, which fixes the position of
+/// each field ("slot") in the line.  The literal text is written once by
+/// parse(), with blank slots, and set() formats a value into a single slot
+/// exactly as format() would, without touching the rest of the line.
+/// Output narrower than the width is padded with spaces; wider output
+/// can't fit, so fills the slot with '#' (use a precision such as "%-6.6s"
+/// to truncate strings instead).
+class FixedLayout
+{
+    public:
+        FixedLayout() { }
+
+        /// Parse the format string `fmt` and render its literal text.
+        ///
+        /// Returns false and stores a message in `error` (if non-null) if
+        /// the format string is invalid, or if a conversion is positional or
+        /// lacks a literal width, in which case *this is left unchanged.
+        bool parse(const std::string& fmt, std::string* error = 0);
+
+        /// Return the number of slots, one per conversion
+        std::size_t numSlots() const { return m_slots.size(); }
+
+        /// Format `value` into slot `slot` (counting from zero)
+        template<typename T>
+        void set(std::size_t slot, const T& value)
+        {
+            setArg(slot, detail::FormatArg(value));
+        }
+
+        /// Return the rendered line
+        const std::string& str() const { return m_line; }
+        const char* data() const { return m_line.data(); }
+        std::size_t size() const { return m_line.size(); }
+
+    private:
+        struct Slot
+        {
+            // Position in m_line
+            std::size_t offset;
+            // Range of conversion spec text in m_fmt
+            std::size_t specBegin;
+            std::size_t specEnd;
+            detail::FormatSpec spec;
+        };
+
+        void setArg(std::size_t slot, const detail::FormatArg& arg);
+
+        std::string m_fmt;
+        std::string m_line;
+        std::vector<Slot> m_slots;
+};
+
+
+inline bool FixedLayout::parse(const std::string& fmt, std::string* error)
+{
+    FixedLayout result;
+    result.m_fmt = fmt;
+    const char* fmtBegin = result.m_fmt.c_str();
+    const char* c = fmtBegin;
+    while (true) {
+        c = detail::appendFormatStringLiteral(result.m_line, c);
+        if (*c == '\0')
+            break;
+        Slot slot;
+        slot.offset = result.m_line.size();
+        slot.specBegin = c - fmtBegin;
+        bool positionalMode = false;
+        const char* parseError = 0;
+        c = detail::parseFormatSpec(slot.spec, positionalMode, c, &parseError);
+        if (!c)
+            return detail::setError(error, parseError);
+        slot.specEnd = c - fmtBegin;
+        const std::string specStr(fmt, slot.specBegin, slot.specEnd - slot.specBegin);
+        if (!detail::conversionClass(slot.spec.conv))
+            return detail::setError(error, format("tinyformat: Unknown conversion '%%%c'", slot.spec.conv));
+        if (positionalMode || slot.spec.widthArg != detail::FormatSpec::NoArg ||
+            slot.spec.precisionArg != detail::FormatSpec::NoArg)
+            return detail::setError(error, format("tinyformat: Conversion '%s' in fixed layout "
+                                      "refers to another argument", specStr));
+        if (!slot.spec.widthSet)
+            return detail::setError(error, format("tinyformat: Conversion '%s' in fixed layout "
+                                      "has no width", specStr));
+        int argIndex = 0;
+        detail::resolveFormatSpec(slot.spec, 0, argIndex, 0);
+        result.m_line.append(static_cast<std::size_t>(slot.spec.width), ' ');
+        result.m_slots.push_back(slot);
+    }
+    *this = result;
+    return true;
+}
+
+
+inline void FixedLayout::setArg(std::size_t slot, const detail::FormatArg& arg)
+{
+    TINYFORMAT_ASSERT(slot < m_slots.size());
+    const Slot& s = m_slots[slot];
+    char* field = &m_line[s.offset];
+    const std::size_t width = static_cast<std::size_t>(s.spec.width);
+    const char* fmt = m_fmt.c_str();
+    detail::ChunkSink sink(field, width, 0);
+    detail::formatArgument(sink, s.spec, arg, fmt + s.specBegin, fmt + s.specEnd,
+                           detail::useNativeNumerics(0));
+    if (sink.dropped())
+        std::memset(field, '#', width);
+    else
+        std::memset(field + sink.size(), ' ', width - sink.size());
+}
+
+
+/// A set of format strings looked up by key, validated when loaded.
+///
+/// Catalogs are intended to be loaded once at startup; lookups may then be
+/// made concurrently from several threads.  Handles returned by find() stay
+/// valid for the lifetime of the catalog, though reloading a key replaces
+/// the format it refers to.
+class FormatCatalog
+{
+    public:
+        /// Declare the argument signature for messages with the given key;
+        /// see ParsedFormat::parse().  Declarations apply to messages added
+        /// afterward: those for undeclared keys are only checked for
+        /// syntax errors.
+        void declare(const std::string& key, const std::string& signature)
+        {
+            m_signatures[key] = signature;
+        }
+
+        /// Parse and add a single message, replacing any existing message
+        /// with the same key.  Returns false and stores a message in `error`
+        /// (if non-null) if the format is invalid, in which case the catalog
+        /// is left unchanged.
+        bool add(const std::string& key, const std::string& fmt,
+                 std::string* error = 0)
+        {
+            std::map<std::string, std::string>::const_iterator sig =
+                m_signatures.find(key);
+            ParsedFormat parsed;
+            if (!parsed.parse(fmt, sig == m_signatures.end() ? 0 : sig->second.c_str(),
+                              error))
+                return false;
+            m_formats[key] = parsed;
+            return true;
+        }
+
+        /// Load messages from the catalog file contents in `data`.
+        ///
+        /// Invalid entries are skipped; if there are any, false is returned
+        /// and a line describing each is appended to `errors` (if non-null).
+        bool load(const char* data, std::size_t size, std::string* errors = 0);
+
+        /// Load messages from the file at `path`, as for load()
+        bool loadFile(const char* path, std::string* errors = 0)
+        {
+            FILE* file = fopen(path, "rb");
+            if (!file) {
+                if (errors)
+                    formatTo(*errors, "%s: could not open file\n", path);
+                return false;
+            }
+            std::string contents;
+            char buf[4096];
+            std::size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), file)) > 0)
+                contents.append(buf, n);
+            const bool readError = ferror(file) != 0;
+            fclose(file);
+            if (readError) {
+                if (errors)
+                    formatTo(*errors, "%s: could not read file\n", path);
+                return false;
+            }
+            return load(contents.data(), contents.size(), errors);
+        }
+
+        /// Return the message with the given key, or null if there's none
+        const ParsedFormat* find(const std::string& key) const
+        {
+            std::map<std::string, ParsedFormat>::const_iterator i = m_formats.find(key);
+            return i == m_formats.end() ? 0 : &i->second;
+        }
+
+        /// Return the number of messages in the catalog
+        std::size_t size() const { return m_formats.size(); }
+
+    private:
+        std::map<std::string, std::string> m_signatures;
+        std::map<std::string, ParsedFormat> m_formats;
+};
+
+
+inline bool FormatCatalog::load(const char* data, std::size_t size,
+                                std::string* errors)
+{
+    bool ok = true;
+    const char* end = data + size;
+    int lineNum = 0;
+    for (const char* line = data; line < end; ) {
+        const char* lineEnd = line;
+        while (lineEnd < end && *lineEnd != '\n')
+            ++lineEnd;
+        const char* next = lineEnd + 1;
+        ++lineNum;
+        // Trim surrounding whitespace, including any '\r'
+        while (line < lineEnd && std::isspace((unsigned char)*line))
+            ++line;
+        while (lineEnd > line && std::isspace((unsigned char)lineEnd[-1]))
+            --lineEnd;
+        if (line == lineEnd || *line == '#') {
+            line = next;
+            continue;
+        }
+        const char* eq = line;
+        while (eq < lineEnd && *eq != '=')
+            ++eq;
+        const char* keyEnd = eq;
+        while (keyEnd > line && std::isspace((unsigned char)keyEnd[-1]))
+            --keyEnd;
+        std::string key(line, keyEnd);
+        std::string error;
+        if (eq == lineEnd || key.empty()) {
+            error = "expected \"key = format\"";
+        }
+        else {
+            // Unescape the format string
+            const char* c = eq + 1;
+            while (c < lineEnd && std::isspace((unsigned char)*c))
+                ++c;
+            std::string fmt;
+            fmt.reserve(lineEnd - c);
+            for (; c < lineEnd && error.empty(); ++c) {
+                if (*c != '\\') {
+                    fmt += *c;
+                    continue;
+                }
+                switch (++c < lineEnd ? *c : '\0') {
+                    case 'n':  fmt += '\n'; break;
+                    case 't':  fmt += '\t'; break;
+                    case '\\': fmt += '\\'; break;
+                    default:   error = "invalid escape sequence"; break;
+                }
+            }
+            if (error.empty())
+                add(key, fmt, &error);
+        }
+        if (!error.empty()) {
+            ok = false;
+            if (errors) {
+                formatTo(*errors, "line %d: %s%s%s\n", lineNum, key,
+                         key.empty() ? "" : ": ", error);
+            }
+        }
+        line = next;
+    }
+    return ok;
+}
+
+
+} // namespace tinyformat
+
+#endif // TINYFORMAT_CATALOG_H_INCLUDED
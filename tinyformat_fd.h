@@ -0,0 +1,122 @@
+// tinyformat_fd.h
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// Output to file descriptors
+//
+// FdSink writes formatted output straight to a POSIX file descriptor (or a
+// C runtime one on Windows), without going through stdio or iostreams:
+//
+//   tfm::FdSink out(1);
+//   tfm::format(out, "%d items\n", count);
+//
+// This is kept out of tinyformat.h so that <unistd.h>, and the read(),
+// write() and close() it declares, aren't pulled into every includer.
+// TINYFORMAT_HAS_FD_SINK is defined where FdSink is available.
+
+#ifndef TINYFORMAT_FD_H_INCLUDED
+#define TINYFORMAT_FD_H_INCLUDED
+
+#include "tinyformat.h"
+
+#if defined(_WIN32)
+#   include <io.h>
+#   define TINYFORMAT_HAS_FD_SINK
+#elif defined(__unix__) || defined(__APPLE__)
+#   include <unistd.h>
+#   define TINYFORMAT_HAS_FD_SINK
+#endif
+
+#ifdef TINYFORMAT_HAS_FD_SINK
+
+#include <cerrno>
+#include <climits>
+
+namespace tinyformat {
+
+/// Sink writing to a file descriptor.
+///
+/// Output is buffered, and written with a single system call per bufferful
+/// when the buffer fills, flush() is called or the sink is destroyed.
+class FdSink : public Sink
+{
+    public:
+        explicit FdSink(int fd) : m_fd(fd), m_failed(false)
+        {
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        ~FdSink() { flush(); }
+
+        /// Write any buffered output.  Returns false if any write to the file
+        /// descriptor has failed.
+        bool flush()
+        {
+            writeAll(m_buf, static_cast<std::size_t>(windowPos() - m_buf));
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+            return !m_failed;
+        }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            flush();
+            if (n < sizeof(m_buf))
+                append(s, n);
+            else
+                writeAll(s, n);
+        }
+
+    private:
+        void writeAll(const char* s, std::size_t n)
+        {
+            while (n > 0 && !m_failed) {
+#               ifdef _WIN32
+                int nwritten = _write(m_fd, s, static_cast<unsigned int>((std::min)(n, std::size_t(INT_MAX))));
+#               else
+                ssize_t nwritten = ::write(m_fd, s, n);
+#               endif
+                if (nwritten < 0) {
+                    if (errno != EINTR)
+                        m_failed = true;
+                    continue;
+                }
+                s += nwritten;
+                n -= static_cast<std::size_t>(nwritten);
+            }
+        }
+
+        int m_fd;
+        bool m_failed;
+        char m_buf[512];
+};
+
+} // namespace tinyformat
+
+#endif // TINYFORMAT_HAS_FD_SINK
+
+#endif // TINYFORMAT_FD_H_INCLUDED
@@ -0,0 +1,100 @@
+// Test that the C++20 module interface in tinyformat.cppm exports a usable
+// API.  This translation unit imports the module instead of including
+// tinyformat.h, and checks a few formatting calls through each part of the
+// exported interface, including user defined types found by argument
+// dependent lookup.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+import tinyformat;
+
+#ifdef TINYFORMAT_H_INCLUDED
+#   error "tinyformat.h macros leaked through the module import"
+#endif
+
+namespace test {
+// User type formatted with operator<<
+struct Point { int x, y; };
+std::ostream& operator<<(std::ostream& out, const Point& p)
+{
+    return out << '(' << p.x << ", " << p.y << ')';
+}
+
+// User type formatted natively with tinyformatTo()
+struct Id { int value; };
+void tinyformatTo(tfm::Sink& out, const tfm::FormatSpec& /*spec*/, const Id& id)
+{
+    out.append("id-", 3);
+    out.put(static_cast<char>('0' + id.value % 10));
+}
+}
+
+static int nfailed = 0;
+
+static void check(const std::string& expected, const std::string& result, int line)
+{
+    if (result != expected) {
+        std::printf("test failed, line %d\n", line);
+        std::printf("\"%s\" != \"%s\"\n", result.c_str(), expected.c_str());
+        ++nfailed;
+    }
+}
+
+#define CHECK_EQUAL(expected, result) check(expected, result, __LINE__)
+
+
+int main()
+{
+    CHECK_EQUAL("1.50 0x2a abc", tfm::format("%.2f %#x %s", 1.5, 42, "abc"));
+    CHECK_EQUAL("(1, 2) id-7", tfm::format("%s %s", test::Point{1, 2}, test::Id{7}));
+
+    std::ostringstream oss;
+    tfm::format(oss, "%d-%s", 10, std::string("ten"));
+    CHECK_EQUAL("10-ten", oss.str());
+
+    char buf[32];
+    std::size_t len = tfm::formatTo(buf, sizeof(buf), "%5d|%-3s|", 12, "ab");
+    CHECK_EQUAL("   12|ab |", std::string(buf, len));
+    CHECK_EQUAL("6", tfm::format("%zu", tfm::formattedSize("%d%%%s", 100, "ab")));
+
+    // Argument lists
+    auto args = tfm::makeFormatList(1, "two", 3.0);
+    std::ostringstream oss2;
+    tfm::vformat(oss2, "%d %s %g", args);
+    CHECK_EQUAL("1 two 3", oss2.str());
+    tfm::DynamicFormatList dynArgs;
+    dynArgs.push(42);
+    dynArgs.push(std::string("answer"));
+    std::ostringstream oss3;
+    tfm::vformat(oss3, "%2$s=%1$d", dynArgs);
+    CHECK_EQUAL("answer=42", oss3.str());
+
+    // Sinks and argument wrappers
+    std::string str;
+    {
+        tfm::StringSink sink(str);
+        tfm::format(sink, "[%s]", tfm::hexbytes("\x01\xab", 2));
+    }
+    CHECK_EQUAL("[01ab]", str);
+    int values[] = {1, 2, 3};
+    CHECK_EQUAL("[1, 2, 3]", tfm::format("[%s]", tfm::range(values)));
+
+#ifdef TINYFORMAT_USE_CAPACITY_HINTS
+    // Capacity hints, when the module is built with them
+    tfm::resetCapacityHints();
+    const char* hintFmt = "%s|%d";
+    CHECK_EQUAL("0", tfm::format("%zu", tfm::capacityHint(hintFmt)));
+    CHECK_EQUAL("abc|1", tfm::format(hintFmt, "abc", 1));
+    CHECK_EQUAL("5", tfm::format("%zu", tfm::capacityHint(hintFmt)));
+    tfm::CapacityHintStats stats = tfm::capacityHintStats();
+    CHECK_EQUAL("1", tfm::format("%d", stats.used != 0));
+#endif
+
+    if (nfailed != 0)
+        std::printf("%d module tests failed\n", nfailed);
+    return nfailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,379 @@
+// tinyformat_ostream.h
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// std::ostream output: OstreamSink, BufferedOstreamSink, format() to a
+// std::ostream, printf() and printfln().
+//
+// tinyformat.h includes this header itself unless TINYFORMAT_NO_IOSTREAM is
+// defined, so normally there's no need to include it directly.  With
+// TINYFORMAT_NO_IOSTREAM, including this header instead of (or after)
+// tinyformat.h adds the std::ostream API back.  Only built-in types can then
+// be formatted, in the "C" locale, as for the rest of the iostream-free API.
+
+#ifndef TINYFORMAT_OSTREAM_INCLUDED
+#define TINYFORMAT_OSTREAM_INCLUDED
+
+#include "tinyformat.h"
+
+#include <iostream>
+
+namespace tinyformat {
+
+/// Sink writing to a std::ostream.
+///
+/// Output is collected in a small buffer and written straight to the stream
+/// buffer with sputn(), under a single sentry held for the lifetime of the
+/// sink, rather than with a sentry and std::ostream::write() for each piece
+/// of output.  Nothing is written if the stream isn't good() to begin with,
+/// and badbit is set on the stream if writing fails.
+class OstreamSink : public Sink
+{
+    public:
+        explicit OstreamSink(std::ostream& out)
+            : m_out(out), m_sentry(out), m_failed(false)
+        {
+            if (m_sentry)
+                setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        ~OstreamSink()
+        {
+            try {
+                flush();
+            }
+            catch (...) {
+                // Failure is recorded in the stream state regardless
+            }
+        }
+
+        /// Write any buffered output to the stream.  Returns false, and sets
+        /// badbit on the stream (which may throw according to its
+        /// exceptions() mask) if any write has failed.
+        bool flush()
+        {
+            writeBuffer();
+            if (m_failed)
+                m_out.setstate(std::ios::badbit);
+            return !m_failed;
+        }
+
+        virtual std::ostream* ostream()
+        {
+            writeBuffer();
+            return &m_out;
+        }
+
+        virtual const std::ostream* localeStream() { return &m_out; }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            if (!m_sentry)
+                return;
+            writeBuffer();
+            if (n < sizeof(m_buf))
+                append(s, n);
+            else
+                write(s, n);
+        }
+
+    private:
+        void writeBuffer()
+        {
+            if (!m_sentry)
+                return;
+            write(m_buf, static_cast<std::size_t>(windowPos() - m_buf));
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        void write(const char* s, std::size_t n)
+        {
+            if (n == 0 || m_failed)
+                return;
+            try {
+                const std::streamsize count = static_cast<std::streamsize>(n);
+                if (m_out.rdbuf()->sputn(s, count) != count)
+                    m_failed = true;
+            }
+            catch (...) {
+                m_failed = true;
+            }
+        }
+
+        std::ostream& m_out;
+        std::ostream::sentry m_sentry;
+        bool m_failed;
+        char m_buf[256];
+};
+
+
+namespace detail {
+
+// Write [s, s+n) to the stream buffer of `out` with a single sputn() under a
+// single sentry.  Returns false, and sets badbit on the stream if the write
+// fails.
+inline bool writeAtomic(std::ostream& out, const char* s, std::size_t n)
+{
+    std::ostream::sentry sentry(out);
+    if (!sentry)
+        return false;
+    bool failed = false;
+    try {
+        const std::streamsize count = static_cast<std::streamsize>(n);
+        failed = out.rdbuf()->sputn(s, count) != count;
+    }
+    catch (...) {
+        failed = true;
+    }
+    if (failed)
+        out.setstate(std::ios::badbit);
+    return !failed;
+}
+
+// Size of the stack buffer in which printf() and printfln() assemble lines
+const std::size_t lineBufSize = 512;
+
+// Format a complete line and write it to `out` in one piece, so that lines
+// printed by concurrent threads aren't interleaved, and the stream buffer
+// (with any lock it takes) is entered only once per line.
+inline void printLine(std::ostream& out, const char* fmt, FormatListRef list,
+                      bool newline)
+{
+#ifndef TINYFORMAT_USE_C_LOCALE
+    if (out.getloc() != std::locale()) {
+        // The line buffer formats numbers as for a new stream, so honour an
+        // unusual stream locale by writing through the stream instead.
+        OstreamSink sink(out);
+        vformat(sink, fmt, list);
+        if (newline)
+            sink.put('\n');
+        sink.flush();
+        return;
+    }
+#endif
+    StackBuffer<lineBufSize> line;
+    vformat(line, fmt, list);
+    if (newline)
+        line.put('\n');
+    writeAtomic(out, line.data(), line.size());
+}
+
+} // namespace detail
+
+
+/// Sink batching complete messages for a stream, owned by a single thread.
+///
+/// Output is collected in a private buffer and written to the stream buffer
+/// with a single sputn() when endMessage() finds that flushSize characters
+/// are pending or (with C++11) that the first pending message is older than
+/// flushInterval.  Messages are never split between writes, and threads
+/// which each own a sink enter the shared stream far less often than with
+/// one write per message.  Numbers are formatted according to the locale
+/// of the target stream, and user defined types via a temporary stream with
+/// its locale and format flags, so that messages aren't split.
+///
+///   tfm::BufferedOstreamSink log(std::cerr);
+///   tfm::format(log, "%s: %d\n", name, value);
+///   log.endMessage();
+class BufferedOstreamSink : public Sink
+{
+    public:
+#ifdef TINYFORMAT_HAS_CHRONO
+        typedef std::chrono::steady_clock Clock;
+
+        explicit BufferedOstreamSink(std::ostream& out, std::size_t flushSize = 4096,
+                                     Clock::duration flushInterval = std::chrono::milliseconds(100))
+            : m_out(out), m_flushSize(flushSize), m_flushInterval(flushInterval),
+            m_hasMessages(false)
+#else
+        explicit BufferedOstreamSink(std::ostream& out, std::size_t flushSize = 4096)
+            : m_out(out), m_flushSize(flushSize)
+#endif
+        {
+            m_buf.resize(flushSize + 256);
+            setWindow(&m_buf[0], &m_buf[0] + m_buf.size());
+        }
+
+        ~BufferedOstreamSink()
+        {
+            try {
+                flush();
+            }
+            catch (...) {
+                // Failure is recorded in the stream state regardless
+            }
+        }
+
+        /// Mark the end of a message, writing all buffered output if it has
+        /// reached the size or time limit.
+        void endMessage()
+        {
+            if (pending() >= m_flushSize) {
+                flush();
+                return;
+            }
+#ifdef TINYFORMAT_HAS_CHRONO
+            if (pending() == 0)
+                return;
+            const Clock::time_point now = Clock::now();
+            if (!m_hasMessages) {
+                m_firstMessage = now;
+                m_hasMessages = true;
+            }
+            if (now - m_firstMessage >= m_flushInterval)
+                flush();
+#endif
+        }
+
+        /// Write all buffered output to the stream.  Returns false, and sets
+        /// badbit on the stream (which may throw according to its
+        /// exceptions() mask), if writing fails.
+        bool flush()
+        {
+            const std::size_t n = pending();
+            setWindow(&m_buf[0], &m_buf[0] + m_buf.size());
+#ifdef TINYFORMAT_HAS_CHRONO
+            m_hasMessages = false;
+#endif
+            return n == 0 || detail::writeAtomic(m_out, &m_buf[0], n);
+        }
+
+        virtual const std::ostream* localeStream() { return &m_out; }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            const std::size_t used = pending();
+            grow(n);
+            std::memcpy(&m_buf[used], s, n);
+            setWindow(&m_buf[0] + used + n, &m_buf[0] + m_buf.size());
+        }
+
+        virtual void grow(std::size_t n)
+        {
+            const std::size_t used = pending();
+            m_buf.resize((std::max)(2*m_buf.size(), used + n));
+            setWindow(&m_buf[0] + used, &m_buf[0] + m_buf.size());
+        }
+
+    private:
+        std::size_t pending() const
+        {
+            return static_cast<std::size_t>(windowPos() - m_buf.data());
+        }
+
+        std::ostream& m_out;
+        std::string m_buf;
+        std::size_t m_flushSize;
+#ifdef TINYFORMAT_HAS_CHRONO
+        Clock::duration m_flushInterval;
+        Clock::time_point m_firstMessage;
+        bool m_hasMessages;
+#endif
+};
+
+/// Format list of arguments to the stream according to the given format string.
+inline void vformat(std::ostream& out, const char* fmt, FormatListRef list)
+{
+    OstreamSink sink(out);
+    vformat(sink, fmt, list);
+    sink.flush();
+}
+
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+
+/// Format list of arguments to the stream according to given format string.
+template<typename... Args>
+void format(std::ostream& out, const char* fmt, const Args&... args)
+{
+    vformat(out, fmt, makeFormatList(args...));
+}
+
+/// Format list of arguments to std::cout, according to the given format
+/// string.  The output is written to std::cout in one piece, so isn't
+/// interleaved with that of printf() calls in other threads.
+template<typename... Args>
+void printf(const char* fmt, const Args&... args)
+{
+    detail::printLine(std::cout, fmt, makeFormatList(args...), false);
+}
+
+/// As printf(), followed by a newline written along with the output
+template<typename... Args>
+void printfln(const char* fmt, const Args&... args)
+{
+    detail::printLine(std::cout, fmt, makeFormatList(args...), true);
+}
+
+#else // C++98 version
+
+inline void format(std::ostream& out, const char* fmt)
+{
+    vformat(out, fmt, makeFormatList());
+}
+
+inline void printf(const char* fmt)
+{
+    detail::printLine(std::cout, fmt, makeFormatList(), false);
+}
+
+inline void printfln(const char* fmt)
+{
+    detail::printLine(std::cout, fmt, makeFormatList(), true);
+}
+
+#define TINYFORMAT_MAKE_OSTREAM_FUNCS(n)                                  \
+                                                                          \
+template<TINYFORMAT_ARGTYPES(n)>                                          \
+void format(std::ostream& out, const char* fmt, TINYFORMAT_VARARGS(n))    \
+{                                                                         \
+    vformat(out, fmt, makeFormatList(TINYFORMAT_PASSARGS(n)));            \
+}                                                                         \
+                                                                          \
+template<TINYFORMAT_ARGTYPES(n)>                                          \
+void printf(const char* fmt, TINYFORMAT_VARARGS(n))                       \
+{                                                                         \
+    detail::printLine(std::cout, fmt,                                     \
+                      makeFormatList(TINYFORMAT_PASSARGS(n)), false);     \
+}                                                                         \
+                                                                          \
+template<TINYFORMAT_ARGTYPES(n)>                                          \
+void printfln(const char* fmt, TINYFORMAT_VARARGS(n))                     \
+{                                                                         \
+    detail::printLine(std::cout, fmt,                                     \
+                      makeFormatList(TINYFORMAT_PASSARGS(n)), true);      \
+}
+
+TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_OSTREAM_FUNCS)
+#undef TINYFORMAT_MAKE_OSTREAM_FUNCS
+
+#endif
+
+} // namespace tinyformat
+
+#endif // TINYFORMAT_OSTREAM_INCLUDED
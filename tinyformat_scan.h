@@ -0,0 +1,911 @@
+// tinyformat_scan.h
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// Type safe scanning
+//
+// tfm::scan() is the counterpart of tfm::format(), reading values back out
+// of text such as log lines with the same format string syntax:
+//
+//   int id = 0;
+//   double price = 0;
+//   std::string client;
+//   if (tfm::scan(line, "order %d filled at %.2f for %s", id, price, client) == 3)
+//       ...
+//
+// As with sscanf(), the number of arguments assigned is returned, and
+// scanning stops at the first part of the input which doesn't match.  Unlike
+// sscanf(), the type of each argument decides how it's read, so there's no
+// way to pass the wrong type or overflow a buffer, and numbers which don't
+// fit the argument don't match.
+//
+// The format is parsed by the same code as for formatting, including
+// positional arguments ("%2$s"), and is matched as follows:
+//
+//   * Whitespace in the format matches any amount of whitespace, including
+//     none.  Other characters must match exactly, and "%%" matches '%'.
+//   * Conversions other than "%c" skip leading whitespace.  A width limits
+//     the number of characters read; flags and precision are ignored, so the
+//     format used to write a line can usually be used to read it back.
+//   * Integers are read in decimal, or in hex for "%x" and "%p" and octal for
+//     "%o" (with an optional 0x prefix for hex), or in the base given by the
+//     prefix for "%i".  A char is read as a single character with "%c" or
+//     "%s", and as a number otherwise.  bool accepts "true", "false", 1 or 0.
+//   * Strings (std::string and char arrays) read a run of non-whitespace
+//     characters, or exactly the width (default 1) with "%c".  Char arrays
+//     are always NUL terminated, and stop reading when full.
+//   * Variable widths and precisions ("%*d") can't be used.
+//
+// Numbers are parsed directly from the input without iostreams.  Decimal
+// floating point values of up to 15 significant digits are converted exactly
+// in a fast path, and others with std::from_chars() where available or
+// strtod() otherwise.  Numbers out of range of the argument type read as
+// strtod() reads them in either case: too large in magnitude gives an
+// infinity, and too small gives zero or a denormal.
+//
+// A ScanFormat holds a format parsed and validated ahead of time, for
+// scanning many lines with the same format.
+
+#ifndef TINYFORMAT_SCAN_H_INCLUDED
+#define TINYFORMAT_SCAN_H_INCLUDED
+
+#include "tinyformat.h"
+
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#if !defined(TINYFORMAT_HAS_FROM_CHARS) && __cplusplus >= 201703L && defined(__has_include)
+#   if __has_include(<charconv>)
+#       include <charconv>
+#       if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#           define TINYFORMAT_HAS_FROM_CHARS
+#       endif
+#   endif
+#endif
+
+namespace tinyformat {
+
+class ScanFormat;
+
+namespace detail {
+
+template<bool> struct ScanArgTypeSupported;
+template<> struct ScanArgTypeSupported<true> { };
+
+inline bool isScanSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline const char* skipScanSpace(const char* in, const char* end)
+{
+    while (in != end && isScanSpace(*in))
+        ++in;
+    return in;
+}
+
+// Return the value of digit `c` in bases up to 16, or 16 if it isn't one
+inline int scanDigitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 16;
+}
+
+// Accumulate the digits of an unsigned integer in base `Base`, returning
+// false on overflow.  The base is a template parameter so that the overflow
+// limits are constants.
+template<int Base>
+bool scanDigits(const char*& in, const char* end, unsigned long long& value)
+{
+    const unsigned long long maxValue = (std::numeric_limits<unsigned long long>::max)();
+    const unsigned long long cutoff = maxValue / Base;
+    const int cutlim = static_cast<int>(maxValue % Base);
+    unsigned long long v = 0;
+    const char* p = in;
+    for (; p != end; ++p) {
+        const int d = scanDigitValue(*p);
+        if (d >= Base)
+            break;
+        if (v > cutoff || (v == cutoff && d > cutlim))
+            return false;
+        v = v*Base + d;
+    }
+    value = v;
+    in = p;
+    return true;
+}
+
+// Parse an unsigned integer in `base`, or with base 0 in the base given by a
+// "0x" or "0" prefix.  Base 16 allows an optional "0x" prefix.  Returns false
+// if there are no digits or the value overflows.
+inline bool scanUnsigned(const char*& in, const char* end, int base,
+                         unsigned long long& value)
+{
+    const char* p = in;
+    if ((base == 16 || base == 0) && end - p > 2 && p[0] == '0' &&
+        (p[1] == 'x' || p[1] == 'X') && scanDigitValue(p[2]) < 16) {
+        p += 2;
+        base = 16;
+    }
+    else if (base == 0) {
+        base = (p != end && *p == '0') ? 8 : 10;
+    }
+    const char* digits = p;
+    bool ok = base == 10 ? scanDigits<10>(p, end, value)
+            : base == 16 ? scanDigits<16>(p, end, value)
+                         : scanDigits<8>(p, end, value);
+    if (!ok || p == digits)
+        return false;
+    in = p;
+    return true;
+}
+
+// Parse an optionally signed integer of type T, which must fit
+template<typename T>
+bool scanInt(const char*& in, const char* end, int base, void* out)
+{
+    const char* p = in;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    unsigned long long magnitude = 0;
+    if (!scanUnsigned(p, end, base, magnitude))
+        return false;
+    const unsigned long long maxValue =
+        static_cast<unsigned long long>((std::numeric_limits<T>::max)());
+    T value;
+    if (std::numeric_limits<T>::is_signed) {
+        if (magnitude > maxValue + (negative ? 1 : 0))
+            return false;
+        value = negative ? static_cast<T>(-static_cast<long long>(magnitude - 1) - 1)
+                         : static_cast<T>(magnitude);
+    }
+    else {
+        if (magnitude > maxValue || (negative && magnitude != 0))
+            return false;
+        value = static_cast<T>(magnitude);
+    }
+    *static_cast<T*>(out) = value;
+    in = p;
+    return true;
+}
+
+// Parse a decimal floating point number whose significand has at most 15
+// digits and exponent at most 22 in magnitude.  Both are then exact doubles,
+// and one multiplication or division gives the correctly rounded result.
+// Returns false for other numbers, which need the general parser.
+inline bool scanDoubleFast(const char*& in, const char* end, double& value)
+{
+    static const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+        1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = in;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    unsigned long long significand = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    bool anyDigits = false;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+        anyDigits = true;
+        if (significand == 0 && *p == '0')
+            continue;
+        if (++numDigits > 15)
+            return false;
+        significand = significand*10 + (*p - '0');
+    }
+    if (p != end && *p == '.') {
+        for (++p; p != end && *p >= '0' && *p <= '9'; ++p) {
+            anyDigits = true;
+            --exponent;
+            if (significand == 0 && *p == '0')
+                continue;
+            if (++numDigits > 15)
+                return false;
+            significand = significand*10 + (*p - '0');
+        }
+    }
+    if (!anyDigits)
+        return false;
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool negativeExp = false;
+        if (e != end && (*e == '-' || *e == '+')) {
+            negativeExp = *e == '-';
+            ++e;
+        }
+        if (e != end && *e >= '0' && *e <= '9') {
+            int exp = 0;
+            for (; e != end && *e >= '0' && *e <= '9'; ++e) {
+                if (exp > 1000)
+                    return false;
+                exp = exp*10 + (*e - '0');
+            }
+            exponent += negativeExp ? -exp : exp;
+            p = e;
+        }
+    }
+    double v = static_cast<double>(significand);
+    if (significand != 0) {
+        if (exponent < -22 || exponent > 22)
+            return false;
+        v = exponent < 0 ? v / powersOf10[-exponent] : v * powersOf10[exponent];
+    }
+    value = negative ? -v : v;
+    in = p;
+    return true;
+}
+
+inline void strToFloat(const char* s, char** end, float& value)
+{
+#   if __cplusplus >= 201103L
+    value = std::strtof(s, end);
+#   else
+    value = static_cast<float>(std::strtod(s, end));
+#   endif
+}
+
+inline void strToFloat(const char* s, char** end, double& value)
+{
+    value = std::strtod(s, end);
+}
+
+inline void strToFloat(const char* s, char** end, long double& value)
+{
+#   if __cplusplus >= 201103L
+    value = std::strtold(s, end);
+#   else
+    value = std::strtod(s, end);
+#   endif
+}
+
+template<typename T>
+bool scanFloatStrtod(const char*& in, const char* end, T& value)
+{
+    // strtod() needs a NUL terminated string
+    char buf[128];
+    const std::size_t len = (std::min)(static_cast<std::size_t>(end - in), sizeof(buf) - 1);
+    std::memcpy(buf, in, len);
+    buf[len] = '\0';
+    char* stop = buf;
+    strToFloat(buf, &stop, value);
+    if (stop == buf)
+        return false;
+    in += stop - buf;
+    return true;
+}
+
+// Parse any floating point number, including hex floats, infinities and NaN.
+// Numbers out of the range of T are read as strtod() reads them whichever
+// parser is used: too large in magnitude gives an infinity, too small gives
+// zero or a denormal.  "0x" without hex digits following reads as "0".
+template<typename T>
+bool scanFloatGeneral(const char*& in, const char* end, T& value)
+{
+#ifdef TINYFORMAT_HAS_FROM_CHARS
+    // from_chars() doesn't accept a '+' sign or the "0x" prefix of hex floats
+    const char* p = in;
+    bool negative = false;
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p != end && *p == '-')
+        return false;
+    std::from_chars_result result = { p, std::errc::invalid_argument };
+    if (end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') && p[2] != '-')
+        result = std::from_chars(p + 2, end, value, std::chars_format::hex);
+    if (result.ec == std::errc::invalid_argument)
+        result = std::from_chars(p, end, value, std::chars_format::general);
+    // from_chars() reports out of range values as errors, without a value
+    if (result.ec == std::errc::result_out_of_range)
+        return scanFloatStrtod(in, end, value);
+    if (result.ec != std::errc())
+        return false;
+    if (negative)
+        value = -value;
+    in = result.ptr;
+    return true;
+#else
+    return scanFloatStrtod(in, end, value);
+#endif
+}
+
+template<typename T>
+bool scanFloat(const char*& in, const char* end, char conv, void* out)
+{
+    T& value = *static_cast<T*>(out);
+    double fast = 0;
+    // The fast path would read the 0 of a hex float and stop
+    const bool mayBeHex = conv == 'a' || conv == 'A' ||
+                          (end - in > 1 && (in[1] == 'x' || in[1] == 'X' ||
+                                            (end - in > 2 && (in[2] == 'x' || in[2] == 'X'))));
+    if (sizeof(T) == sizeof(double) && !mayBeHex && scanDoubleFast(in, end, fast)) {
+        value = static_cast<T>(fast);
+        return true;
+    }
+    return scanFloatGeneral(in, end, value);
+}
+
+inline bool scanBool(const char*& in, const char* end, bool& value)
+{
+    static const char* const names[] = { "false", "true" };
+    for (int i = 0; i < 2; ++i) {
+        const std::size_t len = std::strlen(names[i]);
+        if (static_cast<std::size_t>(end - in) >= len && std::memcmp(in, names[i], len) == 0) {
+            value = i != 0;
+            in += len;
+            return true;
+        }
+    }
+    if (in != end && (*in == '0' || *in == '1')) {
+        value = *in == '1';
+        ++in;
+        return true;
+    }
+    return false;
+}
+
+
+// Type-erased reference to an argument to be scanned into
+class ScanArg
+{
+    public:
+        ScanArg() : m_value(0), m_size(0), m_type(ArgOther) { }
+
+        template<typename T>
+        ScanArg(T& value)
+            : m_value(&value), m_size(0), m_type(ArgTypeOf<T>::value)
+        {
+            // Only non-const built-in numbers, void pointers and std::string
+            // can be scanned into.  Char arrays have their own constructor
+            // which knows their size.
+            (void)sizeof(ScanArgTypeSupported<
+                (ArgTypeOf<T>::value >= ArgBool && ArgTypeOf<T>::value <= ArgPointer) ||
+                ArgTypeOf<T>::value == ArgStdString>);
+        }
+
+        template<std::size_t N>
+        ScanArg(char (&buf)[N])
+            : m_value(buf), m_size(N), m_type(ArgCharArray)
+        { }
+
+        // Read the argument from the input according to `spec`, advancing
+        // `in` past it.  Returns false, leaving `in` and the argument
+        // unchanged, if the input doesn't match.
+        bool scan(const char*& in, const char* end, const FormatSpec& spec) const;
+
+    private:
+        bool scanString(const char*& in, const char* end, const FormatSpec& spec) const;
+
+        void* m_value;
+        // Size of a char array
+        std::size_t m_size;
+        ArgType m_type;
+};
+
+inline bool ScanArg::scan(const char*& in, const char* end, const FormatSpec& spec) const
+{
+    const char conv = spec.conv;
+    const char* p = (conv == 'c') ? in : skipScanSpace(in, end);
+    if (m_type == ArgCharArray || m_type == ArgStdString) {
+        if (!scanString(p, end, spec))
+            return false;
+        in = p;
+        return true;
+    }
+    const char* limit = end;
+    if (spec.widthSet && spec.width > 0 && spec.width < end - p)
+        limit = p + spec.width;
+    int base = 10;
+    switch (conv) {
+        case 'x': case 'X': case 'p': base = 16; break;
+        case 'o':                     base = 8;  break;
+        case 'i':                     base = 0;  break;
+        default:                                 break;
+    }
+    bool ok = false;
+    switch (m_type) {
+        case ArgBool:
+            ok = scanBool(p, limit, *static_cast<bool*>(m_value));
+            break;
+        case ArgChar: case ArgSignedChar: case ArgUnsignedChar:
+            if (conv == 'c' || (conv == 's' && m_type == ArgChar)) {
+                ok = p != limit;
+                if (ok)
+                    std::memcpy(m_value, p++, 1);
+            }
+            else if (m_type == ArgChar)
+                ok = scanInt<char>(p, limit, base, m_value);
+            else if (m_type == ArgSignedChar)
+                ok = scanInt<signed char>(p, limit, base, m_value);
+            else
+                ok = scanInt<unsigned char>(p, limit, base, m_value);
+            break;
+        case ArgShort:            ok = scanInt<short>(p, limit, base, m_value); break;
+        case ArgUnsignedShort:    ok = scanInt<unsigned short>(p, limit, base, m_value); break;
+        case ArgInt:              ok = scanInt<int>(p, limit, base, m_value); break;
+        case ArgUnsignedInt:      ok = scanInt<unsigned int>(p, limit, base, m_value); break;
+        case ArgLong:             ok = scanInt<long>(p, limit, base, m_value); break;
+        case ArgUnsignedLong:     ok = scanInt<unsigned long>(p, limit, base, m_value); break;
+        case ArgLongLong:         ok = scanInt<long long>(p, limit, base, m_value); break;
+        case ArgUnsignedLongLong: ok = scanInt<unsigned long long>(p, limit, base, m_value); break;
+        case ArgFloat:            ok = scanFloat<float>(p, limit, conv, m_value); break;
+        case ArgDouble:           ok = scanFloat<double>(p, limit, conv, m_value); break;
+        case ArgLongDouble:       ok = scanFloat<long double>(p, limit, conv, m_value); break;
+        case ArgPointer: {
+            unsigned long long value = 0;
+            ok = scanUnsigned(p, limit, 16, value);
+            if (ok) {
+                const void* ptr = reinterpret_cast<const void*>(static_cast<std::size_t>(value));
+                std::memcpy(m_value, &ptr, sizeof(ptr));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    if (ok)
+        in = p;
+    return ok;
+}
+
+inline bool ScanArg::scanString(const char*& in, const char* end, const FormatSpec& spec) const
+{
+    const char* p = in;
+    if (spec.conv == 'c') {
+        const int width = spec.widthSet && spec.width > 0 ? spec.width : 1;
+        if (end - p < width)
+            return false;
+        p += width;
+    }
+    else {
+        const char* limit = end;
+        if (spec.widthSet && spec.width > 0 && spec.width < end - p)
+            limit = p + spec.width;
+        while (p != limit && !isScanSpace(*p))
+            ++p;
+        if (p == in)
+            return false;
+    }
+    std::size_t len = static_cast<std::size_t>(p - in);
+    if (m_type == ArgStdString) {
+        static_cast<std::string*>(m_value)->assign(in, len);
+    }
+    else {
+        // Stop reading when the array is full
+        if (len >= m_size) {
+            len = m_size - 1;
+            p = in + len;
+        }
+        char* buf = static_cast<char*>(m_value);
+        std::memcpy(buf, in, len);
+        buf[len] = '\0';
+    }
+    in = p;
+    return true;
+}
+
+// Match the literal part of a format string against the input, up to the
+// next conversion spec or the end of the format, which is returned.
+// `matched` is set false if the input doesn't match.
+inline const char* scanFormatLiteral(const char*& in, const char* end,
+                                     const char* fmt, bool& matched)
+{
+    for (;; ++fmt) {
+        const char c = *fmt;
+        if (c == '\0')
+            return fmt;
+        if (c == '%') {
+            if (fmt[1] != '%')
+                return fmt;
+            // "%%" matches a '%'
+            ++fmt;
+        }
+        if (isScanSpace(c)) {
+            in = skipScanSpace(in, end);
+        }
+        else if (in != end && *in == c) {
+            ++in;
+        }
+        else {
+            matched = false;
+            return fmt;
+        }
+    }
+}
+
+// Match literal text with "%%" already replaced by '%'
+inline bool scanLiteral(const char*& in, const char* end, const char* lit,
+                        const char* litEnd)
+{
+    for (; lit != litEnd; ++lit) {
+        if (isScanSpace(*lit))
+            in = skipScanSpace(in, end);
+        else if (in != end && *in == *lit)
+            ++in;
+        else
+            return false;
+    }
+    return true;
+}
+
+struct ScanListAccess;
+
+} // namespace detail
+
+
+/// List of references to arguments to scan into, the counterpart of
+/// FormatList.  Created with makeScanList().
+class ScanList
+{
+    public:
+        ScanList(const detail::ScanArg* args, int N) : m_args(args), m_N(N) { }
+
+        friend struct detail::ScanListAccess;
+
+    private:
+        const detail::ScanArg* m_args;
+        int m_N;
+};
+
+/// Reference to type-opaque scan list for passing to vscan()
+typedef const ScanList& ScanListRef;
+
+
+namespace detail {
+
+struct ScanListAccess
+{
+    static const ScanArg* args(const ScanList& list) { return list.m_args; }
+    static int size(const ScanList& list) { return list.m_N; }
+};
+
+// Scan list subclass with fixed storage
+template<std::size_t N>
+class ScanListN : public ScanList
+{
+    public:
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+        template<typename... Args>
+        ScanListN(Args&... args)
+            : ScanList(&m_argStore[0], N),
+            m_argStore { ScanArg(args)... }
+        { static_assert(sizeof...(args) == N, "Number of args must be N"); }
+#else // C++98 version
+        void init(int) {}
+#       define TINYFORMAT_MAKE_SCANLIST_CONSTRUCTOR(n)                  \
+                                                                        \
+        template<TINYFORMAT_ARGTYPES(n)>                                \
+        ScanListN(TINYFORMAT_REFARGS(n))                                \
+            : ScanList(&m_argStore[0], n)                               \
+        { TINYFORMAT_ASSERT(n == N); init(0, TINYFORMAT_PASSARGS(n)); } \
+                                                                        \
+        template<TINYFORMAT_ARGTYPES(n)>                                \
+        void init(int i, TINYFORMAT_REFARGS(n))                         \
+        {                                                               \
+            m_argStore[i] = ScanArg(v1);                                \
+            init(i+1 TINYFORMAT_PASSARGS_TAIL(n));                      \
+        }
+
+        TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_SCANLIST_CONSTRUCTOR)
+#       undef TINYFORMAT_MAKE_SCANLIST_CONSTRUCTOR
+#endif
+        ScanListN(const ScanListN& other)
+            : ScanList(&m_argStore[0], N)
+        { std::copy(&other.m_argStore[0], &other.m_argStore[N], &m_argStore[0]); }
+
+    private:
+        ScanArg m_argStore[N];
+};
+
+template<> class ScanListN<0> : public ScanList
+{
+    public: ScanListN() : ScanList(0, 0) {}
+};
+
+inline int scanImpl(const char*& in, const char* end, const char* fmt,
+                    const ScanArg* args, int numArgs)
+{
+    bool positionalMode = false;
+    int argIndex = 0;
+    int assigned = 0;
+    while (true) {
+        bool matched = true;
+        fmt = scanFormatLiteral(in, end, fmt, matched);
+        if (!matched)
+            return assigned;
+        if (*fmt == '\0')
+            break;
+        FormatSpec spec;
+        fmt = parseFormatSpec(spec, positionalMode, fmt);
+        if (spec.widthArg != FormatSpec::NoArg || spec.precisionArg != FormatSpec::NoArg) {
+            TINYFORMAT_ERROR("tinyformat: Variable width or precision can't be scanned");
+            return assigned;
+        }
+        if (positionalMode && argIndex > 0) {
+            TINYFORMAT_ERROR("tinyformat: Positional argument used after a non-positional one");
+            return assigned;
+        }
+        const int index = positionalMode ? spec.argIndex : argIndex++;
+        if (index >= numArgs) {
+            TINYFORMAT_ERROR(positionalMode ? "tinyformat: Positional argument out of range"
+                             : "tinyformat: Too many conversion specifiers in format string");
+            return assigned;
+        }
+        if (!args[index].scan(in, end, spec))
+            return assigned;
+        ++assigned;
+    }
+    if (!positionalMode && argIndex < numArgs)
+        TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
+    return assigned;
+}
+
+} // namespace detail
+
+
+/// A scan format which has been parsed and validated ahead of time.
+///
+/// Scanning with a ScanFormat matches the same input as the original string,
+/// without parsing the conversion specs each time.  A ScanFormat is
+/// immutable once parsed, so may be shared between threads.
+class ScanFormat
+{
+    public:
+        ScanFormat() : m_tailBegin(0), m_numArgs(0) { }
+
+        /// Parse and validate the format string `fmt`.  Returns false and
+        /// stores a message in `error` (if non-null) if the format string is
+        /// invalid, in which case *this is left unchanged.
+        bool parse(const std::string& fmt, std::string* error = 0);
+
+        /// Return the original format string
+        const std::string& str() const { return m_fmt; }
+
+        /// Return the number of arguments used by the format string
+        int numArgs() const { return m_numArgs; }
+
+        // Implementation of vscan(); see there.
+        int scan(const char*& in, const char* end, ScanListRef list) const;
+
+    private:
+        // Literal text followed by a conversion spec
+        struct Segment
+        {
+            // Range of literal text in m_literals
+            std::size_t literalBegin;
+            std::size_t literalEnd;
+            // Argument to read into
+            int argIndex;
+            detail::FormatSpec spec;
+        };
+
+        std::string m_fmt;
+        // Literal text of the format string, with "%%" replaced by '%'
+        std::string m_literals;
+        std::vector<Segment> m_segments;
+        // Start of literal text following the last conversion
+        std::size_t m_tailBegin;
+        int m_numArgs;
+};
+
+
+inline bool ScanFormat::parse(const std::string& fmt, std::string* error)
+{
+    ScanFormat result;
+    result.m_fmt = fmt;
+    const char* fmtBegin = result.m_fmt.c_str();
+    bool positionalMode = false;
+    bool sequentialMode = false;
+    int nextArg = 0;
+    const char* c = fmtBegin;
+    while (true) {
+        std::size_t literalBegin = result.m_literals.size();
+        c = detail::appendFormatStringLiteral(result.m_literals, c);
+        if (*c == '\0') {
+            result.m_tailBegin = literalBegin;
+            break;
+        }
+        Segment seg;
+        seg.literalBegin = literalBegin;
+        seg.literalEnd = result.m_literals.size();
+        const char* specBegin = c;
+        const char* parseError = 0;
+        c = detail::parseFormatSpec(seg.spec, positionalMode, c, &parseError);
+        if (!c)
+            return detail::setError(error, parseError);
+        if (positionalMode && sequentialMode)
+            return detail::setError(error, "tinyformat: Positional argument used after a non-positional one");
+        sequentialMode = !positionalMode;
+        if (seg.spec.widthArg != detail::FormatSpec::NoArg ||
+            seg.spec.precisionArg != detail::FormatSpec::NoArg) {
+            return detail::setError(error, format("tinyformat: Conversion '%s' has a variable width "
+                                      "or precision, which can't be scanned",
+                                      std::string(specBegin, c)));
+        }
+        seg.argIndex = positionalMode ? seg.spec.argIndex : nextArg++;
+        result.m_numArgs = (std::max)(result.m_numArgs, seg.argIndex + 1);
+        result.m_segments.push_back(seg);
+    }
+    *this = result;
+    return true;
+}
+
+inline int ScanFormat::scan(const char*& in, const char* end, ScanListRef list) const
+{
+    const detail::ScanArg* args = detail::ScanListAccess::args(list);
+    const int numArgs = detail::ScanListAccess::size(list);
+    if (numArgs < m_numArgs) {
+        TINYFORMAT_ERROR("tinyformat: Too many conversion specifiers in format string");
+        return 0;
+    }
+    if (numArgs > m_numArgs) {
+        TINYFORMAT_ERROR("tinyformat: Not enough conversion specifiers in format string");
+        return 0;
+    }
+    const char* literals = m_literals.data();
+    int assigned = 0;
+    for (std::size_t i = 0; i < m_segments.size(); ++i) {
+        const Segment& seg = m_segments[i];
+        if (!detail::scanLiteral(in, end, literals + seg.literalBegin,
+                                 literals + seg.literalEnd) ||
+            !args[seg.argIndex].scan(in, end, seg.spec))
+            return assigned;
+        ++assigned;
+    }
+    detail::scanLiteral(in, end, literals + m_tailBegin, literals + m_literals.size());
+    return assigned;
+}
+
+
+/// Scan the input [begin, end) into a list of arguments according to the
+/// format string, returning the number of arguments assigned.  If `stop` is
+/// non-null, it's set to the first character of the input which wasn't
+/// consumed.
+inline int vscan(const char* begin, const char* end, const char* fmt,
+                 ScanListRef list, const char** stop = 0)
+{
+    int assigned = detail::scanImpl(begin, end, fmt, detail::ScanListAccess::args(list),
+                                    detail::ScanListAccess::size(list));
+    if (stop)
+        *stop = begin;
+    return assigned;
+}
+
+/// Scan the input [begin, end) according to a pre-parsed format
+inline int vscan(const char* begin, const char* end, const ScanFormat& fmt,
+                 ScanListRef list, const char** stop = 0)
+{
+    int assigned = fmt.scan(begin, end, list);
+    if (stop)
+        *stop = begin;
+    return assigned;
+}
+
+
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+
+/// Make a type-agnostic list of references to arguments to scan into
+template<typename... Args>
+detail::ScanListN<sizeof...(Args)> makeScanList(Args&... args)
+{
+    return detail::ScanListN<sizeof...(args)>(args...);
+}
+
+/// Scan a NUL terminated string into the arguments according to the format
+/// string, returning the number of arguments assigned.
+template<typename... Args>
+int scan(const char* input, const char* fmt, Args&... args)
+{
+    return vscan(input, input + std::strlen(input), fmt, makeScanList(args...));
+}
+
+/// Scan a string into the arguments according to the format string
+template<typename... Args>
+int scan(const std::string& input, const char* fmt, Args&... args)
+{
+    return vscan(input.data(), input.data() + input.size(), fmt, makeScanList(args...));
+}
+
+/// Scan a NUL terminated string according to a pre-parsed format
+template<typename... Args>
+int scan(const char* input, const ScanFormat& fmt, Args&... args)
+{
+    return vscan(input, input + std::strlen(input), fmt, makeScanList(args...));
+}
+
+/// Scan a string according to a pre-parsed format
+template<typename... Args>
+int scan(const std::string& input, const ScanFormat& fmt, Args&... args)
+{
+    return vscan(input.data(), input.data() + input.size(), fmt, makeScanList(args...));
+}
+
+#else // C++98 version
+
+inline detail::ScanListN<0> makeScanList()
+{
+    return detail::ScanListN<0>();
+}
+#define TINYFORMAT_MAKE_SCAN_FUNCS(n)                                        \
+                                                                             \
+template<TINYFORMAT_ARGTYPES(n)>                                             \
+detail::ScanListN<n> makeScanList(TINYFORMAT_REFARGS(n))                     \
+{                                                                            \
+    return detail::ScanListN<n>(TINYFORMAT_PASSARGS(n));                     \
+}                                                                            \
+                                                                             \
+template<TINYFORMAT_ARGTYPES(n)>                                             \
+int scan(const char* input, const char* fmt, TINYFORMAT_REFARGS(n))          \
+{                                                                            \
+    return vscan(input, input + std::strlen(input), fmt,                     \
+                 makeScanList(TINYFORMAT_PASSARGS(n)));                      \
+}                                                                            \
+                                                                             \
+template<TINYFORMAT_ARGTYPES(n)>                                             \
+int scan(const std::string& input, const char* fmt, TINYFORMAT_REFARGS(n))   \
+{                                                                            \
+    return vscan(input.data(), input.data() + input.size(), fmt,             \
+                 makeScanList(TINYFORMAT_PASSARGS(n)));                      \
+}                                                                            \
+                                                                             \
+template<TINYFORMAT_ARGTYPES(n)>                                             \
+int scan(const char* input, const ScanFormat& fmt, TINYFORMAT_REFARGS(n))    \
+{                                                                            \
+    return vscan(input, input + std::strlen(input), fmt,                     \
+                 makeScanList(TINYFORMAT_PASSARGS(n)));                      \
+}                                                                            \
+                                                                             \
+template<TINYFORMAT_ARGTYPES(n)>                                             \
+int scan(const std::string& input, const ScanFormat& fmt,                    \
+         TINYFORMAT_REFARGS(n))                                              \
+{                                                                            \
+    return vscan(input.data(), input.data() + input.size(), fmt,             \
+                 makeScanList(TINYFORMAT_PASSARGS(n)));                      \
+}
+
+TINYFORMAT_FOREACH_ARGNUM(TINYFORMAT_MAKE_SCAN_FUNCS)
+#undef TINYFORMAT_MAKE_SCAN_FUNCS
+
+#endif
+
+} // namespace tinyformat
+
+#endif // TINYFORMAT_SCAN_H_INCLUDED
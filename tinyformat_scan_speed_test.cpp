@@ -0,0 +1,104 @@
+// Compare the throughput of sscanf() and tfm::scan() reading log lines.
+//
+// Lines are generated with tfm::format() and then parsed back with sscanf(),
+// tfm::scan() with a format string, and tfm::scan() with a pre-parsed
+// ScanFormat.  Each method reports its throughput and a checksum of the
+// values read, which should agree.
+//
+// Usage: tinyformat_scan_speed_test [nlines]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "tinyformat.h"
+#include "tinyformat_scan.h"
+
+typedef std::chrono::steady_clock Clock;
+
+#define LINE_FORMAT "%s [%d] order %u filled at %.2f qty %lld from %s"
+
+std::vector<std::string> makeLines(int nlines)
+{
+    static const char* const levels[] = { "INFO", "WARN", "DEBUG" };
+    static const char* const clients[] = { "alice", "bob", "carol", "dave_the_trader" };
+    std::vector<std::string> lines;
+    lines.reserve(nlines);
+    for (int i = 0; i < nlines; ++i) {
+        lines.push_back(tfm::format(LINE_FORMAT, levels[i % 3], i % 64, 1000000u + i,
+                                    (i % 100000)*0.25, (long long)i*37, clients[i % 4]));
+    }
+    return lines;
+}
+
+// Checksum of the values read from one line
+double checksum(const char* level, int thread, unsigned order, double price,
+                long long qty, const char* client)
+{
+    return level[0] + thread + order + price + qty + client[0];
+}
+
+enum Method { Sscanf, Scan, ScanParsed, ScanString };
+
+double scanLines(Method method, const std::vector<std::string>& lines)
+{
+    double sum = 0;
+    char level[16], client[32];
+    std::string levelStr, clientStr;
+    int thread = 0;
+    unsigned order = 0;
+    double price = 0;
+    long long qty = 0;
+    tfm::ScanFormat parsed;
+    parsed.parse(LINE_FORMAT);
+    for (std::size_t i = 0; i < lines.size(); ++i) {
+        switch (method) {
+            case Sscanf:
+                if (std::sscanf(lines[i].c_str(), "%15s [%d] order %u filled at %lf qty %lld from %31s",
+                                level, &thread, &order, &price, &qty, client) == 6)
+                    sum += checksum(level, thread, order, price, qty, client);
+                break;
+            case Scan:
+                if (tfm::scan(lines[i], LINE_FORMAT, level, thread, order, price, qty, client) == 6)
+                    sum += checksum(level, thread, order, price, qty, client);
+                break;
+            case ScanParsed:
+                if (tfm::scan(lines[i], parsed, level, thread, order, price, qty, client) == 6)
+                    sum += checksum(level, thread, order, price, qty, client);
+                break;
+            case ScanString:
+                if (tfm::scan(lines[i], parsed, levelStr, thread, order, price, qty, clientStr) == 6)
+                    sum += checksum(levelStr.c_str(), thread, order, price, qty, clientStr.c_str());
+                break;
+        }
+    }
+    return sum;
+}
+
+void speedTest(const char* name, Method method, const std::vector<std::string>& lines,
+               std::size_t totalBytes)
+{
+    Clock::time_point start = Clock::now();
+    double sum = scanLines(method, lines);
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::printf("%-12s %7.2f Mlines/s  %7.1f MB/s  %6.1f ns/line  checksum %.2f\n",
+                name, lines.size()/seconds/1e6, totalBytes/seconds/1e6,
+                seconds*1e9/lines.size(), sum);
+}
+
+int main(int argc, char* argv[])
+{
+    int nlines = argc >= 2 ? std::atoi(argv[1]) : 1000000;
+    std::vector<std::string> lines = makeLines(nlines);
+    std::size_t totalBytes = 0;
+    for (std::size_t i = 0; i < lines.size(); ++i)
+        totalBytes += lines[i].size();
+    std::printf("%d lines like \"%s\"\n", nlines, lines[nlines > 1 ? 1 : 0].c_str());
+    speedTest("sscanf", Sscanf, lines, totalBytes);
+    speedTest("scan", Scan, lines, totalBytes);
+    speedTest("scan_parsed", ScanParsed, lines, totalBytes);
+    speedTest("scan_string", ScanString, lines, totalBytes);
+    return 0;
+}
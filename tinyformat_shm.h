@@ -0,0 +1,688 @@
+// tinyformat_shm.h
+// Copyright (C) 2011, Chris Foster [chris42f (at) gmail (d0t) com]
+//
+// Boost Software License - Version 1.0
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+//------------------------------------------------------------------------------
+// Formatting in another process via a shared memory ring buffer
+//
+// A latency sensitive process can hand its messages to another process for
+// formatting.  The producer copies the raw argument values into a single
+// producer, single consumer ring in POSIX shared memory, without formatting
+// anything or taking any locks:
+//
+//   tfm::ShmRingWriter ring;
+//   if (!ring.create("/myapp_log", 1 << 20, &error))
+//       ...
+//   ring.write("order %d filled at %.2f\n", orderId, price);
+//
+// The consumer, typically the tinyformat_shm_consumer program or a thread in
+// a logging daemon, opens the same ring and renders each message with
+// vformat():
+//
+//   tfm::ShmRingReader ring;
+//   ring.open("/myapp_log", &error);
+//   tfm::FdSink out(1);  // from tinyformat_fd.h
+//   while (ring.read(out)) { }
+//
+// Only built-in types can be written: numbers, characters, bools, pointers
+// and strings, which are copied.  Format strings are sent to the consumer
+// the first time each is used and then referred to by number, so they must
+// be string literals or otherwise outlive the writer unchanged.  A producer
+// is never blocked: if the consumer falls behind and the ring is full, the
+// message is dropped and counted in dropped(), which the consumer can
+// report.
+//
+// This header requires C++11 atomics, variadic templates and POSIX shared
+// memory, and defines TINYFORMAT_HAS_SHM_RING when they're available.  Some
+// systems need linking with -lrt for shm_open().
+
+#ifndef TINYFORMAT_SHM_H_INCLUDED
+#define TINYFORMAT_SHM_H_INCLUDED
+
+#include "tinyformat.h"
+
+#if !defined(TINYFORMAT_HAS_SHM_RING) && __cplusplus >= 201103L && \
+    defined(TINYFORMAT_USE_VARIADIC_TEMPLATES) && (defined(__unix__) || defined(__APPLE__))
+#   define TINYFORMAT_HAS_SHM_RING
+#endif
+
+#ifdef TINYFORMAT_HAS_SHM_RING
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tinyformat {
+
+namespace detail {
+
+// Control block at the start of the shared memory, followed by the record
+// data.  Positions count bytes written since the ring was created; the
+// producer and consumer positions are kept on separate cache lines.
+struct ShmRingHeader
+{
+    static const std::uint32_t magicValue = 0x7466726eu;  // "tfrn"
+    static const std::uint32_t currentVersion = 1;
+
+    // Set to magicValue once the rest of the ring is initialized
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t version;
+    // Bytes of record data, a power of two
+    std::uint64_t capacity;
+
+    // Written by the producer
+    alignas(64) std::atomic<std::uint64_t> head;
+    // Messages dropped because the ring was full
+    std::atomic<std::uint64_t> dropped;
+    std::atomic<std::uint32_t> closed;
+
+    // Written by the consumer
+    alignas(64) std::atomic<std::uint64_t> tail;
+    // Incremented when a consumer attaches, so the producer knows to send
+    // its format strings again
+    std::atomic<std::uint32_t> readerEpoch;
+};
+
+// Atomics which aren't lock-free use a lock private to each process, so
+// don't synchronize through shared memory.
+#ifdef __cpp_lib_atomic_is_always_lock_free
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free &&
+              std::atomic<std::uint32_t>::is_always_lock_free,
+              "tinyformat_shm.h needs lock-free 32 and 64 bit atomics");
+#else
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "tinyformat_shm.h needs lock-free 32 and 64 bit atomics");
+#endif
+
+// Records are aligned to this size, so there's always room for a record
+// header before the end of the data.
+const std::size_t shmRecordAlign = 16;
+
+const std::size_t shmDataOffset = (sizeof(ShmRingHeader) + 63) / 64 * 64;
+
+enum ShmRecordKind
+{
+    ShmPadding,  // Unused space before the data wraps around
+    ShmFormat,   // Format string for a format id
+    ShmMessage   // Format id and arguments
+};
+
+struct ShmRecordHeader
+{
+    // Total size of the record including this header, a multiple of
+    // shmRecordAlign
+    std::uint32_t size;
+    std::uint16_t kind;
+    std::uint16_t numArgs;
+    std::uint32_t formatId;
+    std::uint32_t reserved;
+};
+
+// Each argument is stored as its ArgType in one byte followed by the bytes
+// of its value, or for strings as a 32 bit length, the characters and a NUL.
+const std::uint32_t shmNullString = 0xffffffffu;
+
+// Return the size of a value of the given built-in type, or zero for
+// strings and types which can't be stored.
+inline std::size_t shmValueSize(ArgType type)
+{
+    switch (type) {
+        case ArgBool:             return sizeof(bool);
+        case ArgChar:             return sizeof(char);
+        case ArgSignedChar:       return sizeof(signed char);
+        case ArgUnsignedChar:     return sizeof(unsigned char);
+        case ArgShort:            return sizeof(short);
+        case ArgUnsignedShort:    return sizeof(unsigned short);
+        case ArgInt:              return sizeof(int);
+        case ArgUnsignedInt:      return sizeof(unsigned int);
+        case ArgLong:             return sizeof(long);
+        case ArgUnsignedLong:     return sizeof(unsigned long);
+        case ArgLongLong:         return sizeof(long long);
+        case ArgUnsignedLongLong: return sizeof(unsigned long long);
+        case ArgFloat:            return sizeof(float);
+        case ArgDouble:           return sizeof(double);
+        case ArgLongDouble:       return sizeof(long double);
+        case ArgPointer:          return sizeof(const void*);
+        default:                  return 0;
+    }
+}
+
+// Return the string held by a string argument, or null for other types.
+// `isString` is set for string arguments, including null C strings.
+inline const char* shmString(const FormatArg& arg, std::size_t& len, bool& isString)
+{
+    isString = true;
+    const char* s = 0;
+    switch (arg.type()) {
+        case ArgCString:
+            s = *static_cast<const char* const*>(arg.value());
+            len = s ? std::strlen(s) : 0;
+            return s;
+        case ArgCharArray:
+            s = static_cast<const char*>(arg.value());
+            len = std::strlen(s);
+            return s;
+        case ArgStdString: {
+            const std::string& str = *static_cast<const std::string*>(arg.value());
+            len = str.size();
+            return str.c_str();
+        }
+        default:
+            isString = false;
+            return 0;
+    }
+}
+
+// Check at compile time that arguments can be written to a ring
+template<typename T>
+struct ShmArgCheck
+{
+    static const bool value = ArgTypeOf<T>::value >= ArgBool &&
+                              ArgTypeOf<T>::value <= ArgStdString;
+};
+
+template<typename... Args> struct ShmArgsCheck { static const bool value = true; };
+template<typename T, typename... Args>
+struct ShmArgsCheck<T, Args...>
+{
+    static const bool value = ShmArgCheck<T>::value && ShmArgsCheck<Args...>::value;
+};
+
+// Shared memory mapping, unmapped on destruction
+class ShmMapping
+{
+    public:
+        ShmMapping() : m_addr(0), m_size(0) { }
+        ~ShmMapping() { unmap(); }
+
+        // Map the shared memory object `name`, creating it with `size` bytes
+        // if `create` is true, or using its existing size otherwise.
+        bool map(const char* name, std::size_t size, bool create, std::string* error)
+        {
+            unmap();
+            int fd = create ? shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0600)
+                            : shm_open(name, O_RDWR, 0);
+            if (fd < 0)
+                return setError(error, format("%s: could not open shared memory", name));
+            struct stat st;
+            bool ok = create ? ftruncate(fd, static_cast<off_t>(size)) == 0
+                             : fstat(fd, &st) == 0;
+            if (ok && !create)
+                size = static_cast<std::size_t>(st.st_size);
+            void* addr = ok ? mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+                            : MAP_FAILED;
+            close(fd);
+            if (addr == MAP_FAILED)
+                return setError(error, format("%s: could not map shared memory", name));
+            m_addr = addr;
+            m_size = size;
+            return true;
+        }
+
+        void unmap()
+        {
+            if (m_addr)
+                munmap(m_addr, m_size);
+            m_addr = 0;
+            m_size = 0;
+        }
+
+        void* addr() const { return m_addr; }
+        std::size_t size() const { return m_size; }
+
+    private:
+        ShmMapping(const ShmMapping&);
+        ShmMapping& operator=(const ShmMapping&);
+
+        void* m_addr;
+        std::size_t m_size;
+};
+
+} // namespace detail
+
+
+/// Producer end of a shared memory ring; see the top of tinyformat_shm.h.
+///
+/// A writer may only be used by one thread at a time.
+class ShmRingWriter
+{
+    public:
+        ShmRingWriter()
+            : m_header(0), m_data(0), m_mask(0), m_head(0), m_tailCache(0),
+            m_reserved(0), m_readerEpoch(0), m_nextFormatId(0)
+        { }
+
+        ~ShmRingWriter() { close(); }
+
+        /// Create the shared memory object `name` (which should start with
+        /// '/') holding a ring of `capacity` bytes, rounded up to a power of
+        /// two.  Any existing object of that name is replaced.  Returns false
+        /// and stores a message in `error` (if non-null) on failure.
+        bool create(const char* name, std::size_t capacity, std::string* error = 0)
+        {
+            close();
+            std::size_t size = 1024;
+            while (size < capacity)
+                size *= 2;
+            if (!m_mapping.map(name, detail::shmDataOffset + size, true, error))
+                return false;
+            m_header = new (m_mapping.addr()) detail::ShmRingHeader;
+            m_header->version = detail::ShmRingHeader::currentVersion;
+            m_header->capacity = size;
+            m_header->head.store(0, std::memory_order_relaxed);
+            m_header->dropped.store(0, std::memory_order_relaxed);
+            m_header->closed.store(0, std::memory_order_relaxed);
+            m_header->tail.store(0, std::memory_order_relaxed);
+            m_header->readerEpoch.store(0, std::memory_order_relaxed);
+            m_header->magic.store(detail::ShmRingHeader::magicValue, std::memory_order_release);
+            m_data = static_cast<char*>(m_mapping.addr()) + detail::shmDataOffset;
+            m_mask = size - 1;
+            m_head = 0;
+            m_tailCache = 0;
+            m_readerEpoch = 0;
+            m_formatIds.clear();
+            return true;
+        }
+
+        /// Mark the ring closed, so the consumer knows no more messages are
+        /// coming, and unmap it.  The shared memory object itself remains
+        /// until remove() is called.
+        void close()
+        {
+            if (!m_header)
+                return;
+            m_header->closed.store(1, std::memory_order_release);
+            m_header = 0;
+            m_mapping.unmap();
+        }
+
+        /// Remove the shared memory object `name`
+        static bool remove(const char* name) { return shm_unlink(name) == 0; }
+
+        /// Write a message with the given format string and arguments.
+        /// Returns false if the message was dropped because the ring is full.
+        template<typename... Args>
+        bool write(const char* fmt, const Args&... args)
+        {
+            static_assert(detail::ShmArgsCheck<Args...>::value,
+                          "only built-in types can be written to a shared memory ring");
+            return vwrite(fmt, makeFormatList(args...));
+        }
+
+        /// Write a message with arguments from a format list, which may only
+        /// contain built-in types and strings
+        bool vwrite(const char* fmt, FormatListRef list)
+        {
+            TINYFORMAT_ASSERT(m_header);
+            const detail::FormatArg* args = detail::FormatListAccess::args(list);
+            const int numArgs = detail::FormatListAccess::size(list);
+            std::size_t size = sizeof(detail::ShmRecordHeader);
+            for (int i = 0; i < numArgs; ++i) {
+                std::size_t len = 0;
+                bool isString = false;
+                detail::shmString(args[i], len, isString);
+                std::size_t valueSize = isString ? 4 + len + 1 : detail::shmValueSize(args[i].type());
+                if (valueSize == 0) {
+                    TINYFORMAT_ERROR("tinyformat: Argument type can't be written to a shared memory ring");
+                    return false;
+                }
+                size += 1 + valueSize;
+            }
+            std::uint32_t formatId = 0;
+            if (!findFormat(fmt, formatId))
+                return drop();
+            char* p = reserve(size);
+            if (!p)
+                return drop();
+            char* record = p;
+            p += sizeof(detail::ShmRecordHeader);
+            for (int i = 0; i < numArgs; ++i) {
+                std::size_t len = 0;
+                bool isString = false;
+                const char* s = detail::shmString(args[i], len, isString);
+                if (isString) {
+                    *p++ = static_cast<char>(detail::ArgCString);
+                    const std::uint32_t len32 = s ? static_cast<std::uint32_t>(len)
+                                                  : detail::shmNullString;
+                    std::memcpy(p, &len32, 4);
+                    p += 4;
+                    std::memcpy(p, s ? s : "", len + 1);
+                    p += len + 1;
+                }
+                else {
+                    *p++ = static_cast<char>(args[i].type());
+                    const std::size_t valueSize = detail::shmValueSize(args[i].type());
+                    std::memcpy(p, args[i].value(), valueSize);
+                    p += valueSize;
+                }
+            }
+            commit(record, detail::ShmMessage, static_cast<std::uint16_t>(numArgs), formatId);
+            return true;
+        }
+
+        /// Return the number of messages dropped because the ring was full
+        std::uint64_t dropped() const
+        {
+            return m_header ? m_header->dropped.load(std::memory_order_relaxed) : 0;
+        }
+
+    private:
+        ShmRingWriter(const ShmRingWriter&);
+        ShmRingWriter& operator=(const ShmRingWriter&);
+
+        bool drop()
+        {
+            m_header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        static std::size_t recordSize(std::size_t size)
+        {
+            return (size + detail::shmRecordAlign - 1) / detail::shmRecordAlign *
+                   detail::shmRecordAlign;
+        }
+
+        // Look up the id of a format string, first sending it to the
+        // consumer if it hasn't seen it.  Returns false if there's no room.
+        bool findFormat(const char* fmt, std::uint32_t& formatId)
+        {
+            // Pairs with the release in ShmRingReader::open(), so that a
+            // new epoch is seen after the tail the reader started from
+            const std::uint32_t epoch = m_header->readerEpoch.load(std::memory_order_acquire);
+            if (epoch != m_readerEpoch) {
+                // A new consumer doesn't know any formats
+                m_formatIds.clear();
+                m_readerEpoch = epoch;
+            }
+            std::unordered_map<const char*, std::uint32_t>::const_iterator i =
+                m_formatIds.find(fmt);
+            if (i != m_formatIds.end()) {
+                formatId = i->second;
+                return true;
+            }
+            const std::size_t len = std::strlen(fmt);
+            char* p = reserve(sizeof(detail::ShmRecordHeader) + len + 1);
+            if (!p)
+                return false;
+            formatId = m_nextFormatId++;
+            std::memcpy(p + sizeof(detail::ShmRecordHeader), fmt, len + 1);
+            commit(p, detail::ShmFormat, 0, formatId);
+            m_formatIds[fmt] = formatId;
+            return true;
+        }
+
+        // Return space for a record of `size` bytes at the head of the ring,
+        // or null if there isn't enough free space.  Records don't wrap
+        // around the end of the data; a padding record fills the gap.
+        char* reserve(std::size_t size)
+        {
+            size = recordSize(size);
+            const std::size_t capacity = m_mask + 1;
+            if (size > capacity/4)
+                return 0;
+            const std::size_t offset = static_cast<std::size_t>(m_head & m_mask);
+            const std::size_t padding = capacity - offset < size ? capacity - offset : 0;
+            if (m_head + padding + size - m_tailCache > capacity) {
+                // Only read the consumer's position when the cached one
+                // shows the ring as full.
+                m_tailCache = m_header->tail.load(std::memory_order_acquire);
+                if (m_head + padding + size - m_tailCache > capacity)
+                    return 0;
+            }
+            if (padding != 0) {
+                detail::ShmRecordHeader pad = {static_cast<std::uint32_t>(padding),
+                                               detail::ShmPadding, 0, 0, 0};
+                std::memcpy(m_data + offset, &pad, sizeof(pad));
+                m_head += padding;
+            }
+            m_reserved = size;
+            return m_data + (m_head & m_mask);
+        }
+
+        // Fill in the header of the record returned by reserve() and
+        // publish it
+        void commit(char* record, detail::ShmRecordKind kind,
+                    std::uint16_t numArgs, std::uint32_t formatId)
+        {
+            detail::ShmRecordHeader header = {static_cast<std::uint32_t>(m_reserved),
+                                              static_cast<std::uint16_t>(kind),
+                                              numArgs, formatId, 0};
+            std::memcpy(record, &header, sizeof(header));
+            m_head += m_reserved;
+            m_header->head.store(m_head, std::memory_order_release);
+        }
+
+        detail::ShmMapping m_mapping;
+        detail::ShmRingHeader* m_header;
+        char* m_data;
+        std::uint64_t m_mask;
+        std::uint64_t m_head;
+        // Last consumer position read from the ring
+        std::uint64_t m_tailCache;
+        std::size_t m_reserved;
+        std::uint32_t m_readerEpoch;
+        std::uint32_t m_nextFormatId;
+        std::unordered_map<const char*, std::uint32_t> m_formatIds;
+};
+
+
+/// Consumer end of a shared memory ring; see the top of tinyformat_shm.h.
+class ShmRingReader
+{
+    public:
+        ShmRingReader() : m_header(0), m_data(0), m_mask(0), m_tail(0), m_skipped(0) { }
+
+        /// Open the ring created by a writer as `name`, skipping any
+        /// messages which are already waiting.  Returns false and stores a
+        /// message in `error` (if non-null) if there's no valid ring.
+        bool open(const char* name, std::string* error = 0)
+        {
+            m_header = 0;
+            if (!m_mapping.map(name, 0, false, error))
+                return false;
+            detail::ShmRingHeader* header =
+                static_cast<detail::ShmRingHeader*>(m_mapping.addr());
+            if (m_mapping.size() < detail::shmDataOffset ||
+                header->magic.load(std::memory_order_acquire) != detail::ShmRingHeader::magicValue ||
+                header->version != detail::ShmRingHeader::currentVersion ||
+                header->capacity != m_mapping.size() - detail::shmDataOffset) {
+                m_mapping.unmap();
+                return detail::setError(error, format("%s: not a tinyformat ring", name));
+            }
+            m_header = header;
+            m_data = static_cast<const char*>(m_mapping.addr()) + detail::shmDataOffset;
+            m_mask = header->capacity - 1;
+            m_formats.clear();
+            m_skipped = 0;
+            // Skip any messages already written, then tell the writer to
+            // resend its formats.  Bumping the epoch last means a writer
+            // which sees it only writes format records after our tail.
+            m_tail = m_header->head.load(std::memory_order_acquire);
+            m_header->tail.store(m_tail, std::memory_order_release);
+            m_header->readerEpoch.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+
+        /// Format the next message into `out`.  Returns false if no
+        /// message is waiting.
+        bool read(Sink& out)
+        {
+            TINYFORMAT_ASSERT(m_header);
+            while (true) {
+                const std::uint64_t head = m_header->head.load(std::memory_order_acquire);
+                if (m_tail == head)
+                    return false;
+                const char* record = m_data + (m_tail & m_mask);
+                detail::ShmRecordHeader header;
+                std::memcpy(&header, record, sizeof(header));
+                const std::size_t maxSize = static_cast<std::size_t>(m_mask + 1 - (m_tail & m_mask));
+                if (header.size < sizeof(header) || header.size > maxSize ||
+                    header.size % detail::shmRecordAlign != 0 || header.size > head - m_tail) {
+                    // Corrupt data; skip everything written so far
+                    ++m_skipped;
+                    advance(head - m_tail);
+                    continue;
+                }
+                bool formatted = false;
+                if (header.kind == detail::ShmFormat) {
+                    m_formats[header.formatId].assign(record + sizeof(header),
+                        strnlen(record + sizeof(header), header.size - sizeof(header)));
+                }
+                else if (header.kind == detail::ShmMessage) {
+                    formatted = formatMessage(out, header, record);
+                    if (!formatted)
+                        ++m_skipped;
+                }
+                advance(header.size);
+                if (formatted)
+                    return true;
+            }
+        }
+
+        /// Return whether the writer has closed the ring and all its
+        /// messages have been read
+        bool done() const
+        {
+            return m_header->closed.load(std::memory_order_acquire) != 0 &&
+                   m_tail == m_header->head.load(std::memory_order_acquire);
+        }
+
+        /// Return the number of messages lost: dropped by the writer
+        /// because the ring was full, or unreadable here because they
+        /// referred to a format string sent before the reader attached.
+        std::uint64_t dropped() const
+        {
+            return m_header->dropped.load(std::memory_order_relaxed) + m_skipped;
+        }
+
+    private:
+        ShmRingReader(const ShmRingReader&);
+        ShmRingReader& operator=(const ShmRingReader&);
+
+        void advance(std::uint64_t n)
+        {
+            m_tail += n;
+            m_header->tail.store(m_tail, std::memory_order_release);
+        }
+
+        // Rebuild the arguments of a message record and format them.
+        // Returns false if the record can't be decoded.
+        bool formatMessage(Sink& out, const detail::ShmRecordHeader& header,
+                           const char* record)
+        {
+            std::unordered_map<std::uint32_t, std::string>::const_iterator fmt =
+                m_formats.find(header.formatId);
+            if (fmt == m_formats.end())
+                return false;
+            const char* p = record + sizeof(header);
+            const char* end = record + header.size;
+            m_args.clear();
+            for (int i = 0; i < header.numArgs; ++i) {
+                if (p >= end)
+                    return false;
+                // Check the tag before converting it, as it may be corrupt
+                const unsigned char tag = static_cast<unsigned char>(*p++);
+                if (tag > detail::ArgCString)
+                    return false;
+                const detail::ArgType type = static_cast<detail::ArgType>(tag);
+                if (type == detail::ArgCString) {
+                    std::uint32_t len = 0;
+                    if (end - p < 4)
+                        return false;
+                    std::memcpy(&len, p, 4);
+                    p += 4;
+                    if (len == detail::shmNullString) {
+                        m_args.push(static_cast<const char*>(0));
+                        ++p;
+                        continue;
+                    }
+                    if (static_cast<std::size_t>(end - p) <= len || p[len] != '\0')
+                        return false;
+                    m_args.push(p);
+                    p += len + 1;
+                    continue;
+                }
+                const std::size_t valueSize = detail::shmValueSize(type);
+                if (valueSize == 0 || static_cast<std::size_t>(end - p) < valueSize)
+                    return false;
+                pushValue(type, p);
+                p += valueSize;
+            }
+            vformat(out, fmt->second.c_str(), m_args);
+            return true;
+        }
+
+        template<typename T>
+        void pushAs(const char* p)
+        {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            m_args.push(value);
+        }
+
+        void pushValue(detail::ArgType type, const char* p)
+        {
+            switch (type) {
+                case detail::ArgBool:             pushAs<bool>(p); break;
+                case detail::ArgChar:             pushAs<char>(p); break;
+                case detail::ArgSignedChar:       pushAs<signed char>(p); break;
+                case detail::ArgUnsignedChar:     pushAs<unsigned char>(p); break;
+                case detail::ArgShort:            pushAs<short>(p); break;
+                case detail::ArgUnsignedShort:    pushAs<unsigned short>(p); break;
+                case detail::ArgInt:              pushAs<int>(p); break;
+                case detail::ArgUnsignedInt:      pushAs<unsigned int>(p); break;
+                case detail::ArgLong:             pushAs<long>(p); break;
+                case detail::ArgUnsignedLong:     pushAs<unsigned long>(p); break;
+                case detail::ArgLongLong:         pushAs<long long>(p); break;
+                case detail::ArgUnsignedLongLong: pushAs<unsigned long long>(p); break;
+                case detail::ArgFloat:            pushAs<float>(p); break;
+                case detail::ArgDouble:           pushAs<double>(p); break;
+                case detail::ArgLongDouble:       pushAs<long double>(p); break;
+                case detail::ArgPointer:          pushAs<const void*>(p); break;
+                default:                          break;
+            }
+        }
+
+        detail::ShmMapping m_mapping;
+        detail::ShmRingHeader* m_header;
+        const char* m_data;
+        std::uint64_t m_mask;
+        std::uint64_t m_tail;
+        std::uint64_t m_skipped;
+        std::unordered_map<std::uint32_t, std::string> m_formats;
+        DynamicFormatList m_args;
+};
+
+} // namespace tinyformat
+
+#endif // TINYFORMAT_HAS_SHM_RING
+
+#endif // TINYFORMAT_SHM_H_INCLUDED
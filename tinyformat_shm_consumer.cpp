@@ -0,0 +1,97 @@
+// Format messages written to a shared memory ring by another process.
+//
+// Usage: tinyformat_shm_consumer [-r] [-q] /ring_name
+//
+// Waits for a writer to create the ring, then writes each message to stdout
+// until the writer closes the ring or the consumer is interrupted.  Lost
+// messages are reported on stderr.
+//
+//   -r   Remove the ring's shared memory object on exit
+//   -q   Don't report lost messages
+
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+#include "tinyformat.h"
+#include "tinyformat_fd.h"
+#include "tinyformat_shm.h"
+
+#ifndef TINYFORMAT_HAS_SHM_RING
+#   error "tinyformat_shm_consumer needs C++11 and POSIX shared memory"
+#endif
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void onSignal(int) { g_stop = 1; }
+
+// Report messages lost since the last report
+static void reportLost(tfm::Sink& err, const tfm::ShmRingReader& reader,
+                       std::uint64_t& reported)
+{
+    const std::uint64_t dropped = reader.dropped();
+    if (dropped == reported)
+        return;
+    tfm::format(err, "tinyformat_shm_consumer: %d messages lost\n", dropped - reported);
+    reported = dropped;
+}
+
+int main(int argc, char* argv[])
+{
+    bool removeRing = false;
+    bool quiet = false;
+    const char* name = 0;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-r") == 0)
+            removeRing = true;
+        else if (std::strcmp(argv[i], "-q") == 0)
+            quiet = true;
+        else if (!name && argv[i][0] != '-')
+            name = argv[i];
+        else
+            usage = true;
+    }
+    if (!name || usage) {
+        tfm::format(std::cerr, "usage: %s [-r] [-q] /ring_name\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    tfm::ShmRingReader reader;
+    std::string error;
+    while (!reader.open(name, &error)) {
+        if (g_stop) {
+            tfm::format(std::cerr, "%s\n", error);
+            return EXIT_FAILURE;
+        }
+        usleep(10000);
+    }
+
+    tfm::FdSink out(1);
+    tfm::FdSink err(2);
+    std::uint64_t reported = 0;
+    int idle = 0;
+    while (!g_stop && !reader.done()) {
+        if (reader.read(out)) {
+            idle = 0;
+            continue;
+        }
+        // Write out what's been formatted whenever the ring runs dry
+        out.flush();
+        if (!quiet) {
+            reportLost(err, reader, reported);
+            err.flush();
+        }
+        // Back off from spinning to sleeping while the ring stays empty
+        if (++idle > 100)
+            usleep(idle > 1000 ? 1000 : 50);
+    }
+    out.flush();
+    if (!quiet)
+        reportLost(err, reader, reported);
+    if (removeRing)
+        tfm::ShmRingWriter::remove(name);
+    return EXIT_SUCCESS;
+}
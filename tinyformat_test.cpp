@@ -14,14 +14,26 @@ namespace std { class type_info; }
 #include <limits>
 #include <cfloat>
 #include <cstddef>
+#include <cstdio>
+#include <vector>
 
 // Throw instead of abort() so we can test error conditions.
 #define TINYFORMAT_ERROR(reason) \
     throw std::runtime_error(reason);
 
+// Test the std::pmr::memory_resource overload of format(), where available
+#define TINYFORMAT_USE_PMR
 #include "tinyformat.h"
+#include "tinyformat_catalog.h"
+#include "tinyformat_fd.h"
+#include "tinyformat_scan.h"
+#include "tinyformat_shm.h"
 #include <cassert>
 
+#ifdef TINYFORMAT_HAS_SHM_RING
+#   include <sys/wait.h>
+#endif
+
 #if 0
 // Compare result of tfm::format() to C's sprintf().
 template<typename... Args>
@@ -89,6 +101,131 @@ struct TestExceptionDef : public std::runtime_error
 };
 
 
+#ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+// Minimal C++11 allocator which counts the allocations made through it
+template<typename T>
+struct CountingAllocator
+{
+    typedef T value_type;
+    CountingAllocator(int* count) : m_count(count) {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : m_count(other.m_count) {}
+    T* allocate(std::size_t n)
+    {
+        ++*m_count;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+    template<typename U>
+    bool operator==(const CountingAllocator<U>& other) const { return m_count == other.m_count; }
+    template<typename U>
+    bool operator!=(const CountingAllocator<U>& other) const { return m_count != other.m_count; }
+    int* m_count;
+};
+#endif
+
+
+// Numeric punctuation which differs from the classic locale
+struct GroupingNumpunct : public std::numpunct<char>
+{
+    char do_decimal_point() const { return ','; }
+    char do_thousands_sep() const { return '.'; }
+    std::string do_grouping() const { return "\3"; }
+};
+
+
+// Sink which writes through a small window, counting calls to overflow()
+class SmallWindowSink : public tfm::Sink
+{
+    public:
+        SmallWindowSink() : m_overflows(0) { setWindow(m_buf, m_buf + sizeof(m_buf)); }
+
+        std::string str()
+        {
+            flushWindow();
+            return m_str;
+        }
+
+        int overflows() const { return m_overflows; }
+
+    protected:
+        virtual void overflow(const char* s, std::size_t n)
+        {
+            ++m_overflows;
+            flushWindow();
+            m_str.append(s, n);
+        }
+
+    private:
+        void flushWindow()
+        {
+            m_str.append(m_buf, windowPos() - m_buf);
+            setWindow(m_buf, m_buf + sizeof(m_buf));
+        }
+
+        char m_buf[4];
+        std::string m_str;
+        int m_overflows;
+};
+
+
+// Stream buffer with room for only a few characters, after which writes fail
+class TinyStreambuf : public std::streambuf
+{
+    public:
+        TinyStreambuf() { setp(m_buf, m_buf + sizeof(m_buf)); }
+
+        std::string str() const { return std::string(pbase(), pptr()); }
+
+    private:
+        char m_buf[4];
+};
+
+// Unbuffered stream buffer collecting its output and counting the writes
+class CountingStreambuf : public std::streambuf
+{
+    public:
+        CountingStreambuf() : writes(0), syncs(0) { }
+
+        std::string str;
+        int writes;
+        int syncs;
+
+    protected:
+        virtual int sync()
+        {
+            ++syncs;
+            return 0;
+        }
+
+        virtual std::streamsize xsputn(const char* s, std::streamsize n)
+        {
+            ++writes;
+            str.append(s, static_cast<std::size_t>(n));
+            return n;
+        }
+
+        virtual int_type overflow(int_type c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            ++writes;
+            str += traits_type::to_char_type(c);
+            return c;
+        }
+};
+
+
+#ifdef TINYFORMAT_HAS_SHM_RING
+// Append the next message from a shared memory ring to a string
+bool readRing(tfm::ShmRingReader& reader, std::string& str)
+{
+    tfm::StringSink sink(str);
+    return reader.read(sink);
+}
+#endif
+
+
 struct MyInt {
 public:
     MyInt(int value) : m_value(value) {}
@@ -102,6 +239,44 @@ std::ostream& operator<<(std::ostream& os, const MyInt& obj) {
     return os;
 }
 
+#if __cplusplus >= 201103L
+// Over-aligned type which reports whether it's correctly aligned
+struct alignas(32) AlignedInt { int value; };
+
+std::ostream& operator<<(std::ostream& os, const AlignedInt& obj) {
+    const bool aligned = reinterpret_cast<std::size_t>(&obj) % alignof(AlignedInt) == 0;
+    os << obj.value << (aligned ? "" : "(misaligned)");
+    return os;
+}
+#endif
+
+
+// Type formatted directly into the output with tinyformatTo(), found by
+// argument dependent lookup.  There's deliberately no operator<<.
+namespace shop {
+struct Price {
+    Price(long cents) : cents(cents) {}
+    long cents;
+};
+
+void tinyformatTo(tfm::Sink& out, const tfm::FormatSpec& spec, const Price& price)
+{
+    char buf[32];
+    char* p = buf + sizeof(buf);
+    unsigned long c = price.cents < 0 ? -price.cents : price.cents;
+    for (int i = 0; i < 3 || c != 0; ++i, c /= 10) {
+        if (i == 2)
+            *--p = '.';
+        *--p = static_cast<char>('0' + c % 10);
+    }
+    if (spec.conv != 'd')
+        *--p = '$';
+    if (price.cents < 0)
+        *--p = '-';
+    out.append(p, buf + sizeof(buf) - p);
+}
+}
+
 
 int unitTests()
 {
@@ -202,6 +377,10 @@ int unitTests()
 #   endif
     CHECK_EQUAL(tfm::format("%.2s", "asdf"), "as"); // strings truncate to precision
     CHECK_EQUAL(tfm::format("%.2s", std::string("asdf")), "as");
+    // Truncated output is padded to the field width
+    CHECK_EQUAL(tfm::format("%6.2s|%-6.2s|", "asdf", std::string("asdf")), "    as|as    |");
+    CHECK_EQUAL(tfm::format("%6.2s|%-6.3s|", 1234, 1.5), "    12|1.5   |");
+    CHECK_EQUAL(tfm::format("%6.2s", MyInt(1234)), "    12");
     // Test variable precision & width
     CHECK_EQUAL(tfm::format("%*.4f", 10, 1234.1234567890), " 1234.1235");
     CHECK_EQUAL(tfm::format("%10.*f", 4, 1234.1234567890), " 1234.1235");
@@ -235,6 +414,22 @@ int unitTests()
     CHECK_EQUAL(tfm::format("%010d", 100), "0000000100");
     CHECK_EQUAL(tfm::format("%010d", -10), "-000000010"); // sign should extend
     CHECK_EQUAL(tfm::format("%#010X", 0xBEEF), "0X0000BEEF");
+    // Hex and octal against sprintf, over all digit counts
+    {
+        const char* baseFormats[] = {"%llx", "%llX", "%#llx", "%#020llX", "%llo",
+                                     "%#llo", "%-#24llo|"};
+        for (int i = 0; i < 7; ++i) {
+            for (int shift = 0; shift < 64; ++shift) {
+                unsigned long long values[] = {(1ULL << shift) - 1, 0x0123456789abcdefULL >> shift,
+                                               ~0ULL << shift};
+                for (int j = 0; j < 3; ++j) {
+                    char expected[64];
+                    sprintf(expected, baseFormats[i], values[j]);
+                    CHECK_EQUAL(tfm::format(baseFormats[i], values[j]), expected);
+                }
+            }
+        }
+    }
     CHECK_EQUAL(tfm::format("% d",  10), " 10");
     CHECK_EQUAL(tfm::format("% d", -10), "-10");
     // Test flags with variable precision & width
@@ -305,6 +500,12 @@ int unitTests()
     tfm::format("%ls", L"blah");
 #endif
 
+#ifdef TEST_SCAN_TYPE_COMPILE
+    // Only built-in types can be scanned into - should fail to compile!
+    MyInt scanned(0);
+    tfm::scan("1", "%d", scanned);
+#endif
+
     // Test that formatting is independent of underlying stream state.
     std::ostringstream oss;
     oss.width(20);
@@ -314,10 +515,741 @@ int unitTests()
     tfm::format(oss, "%f", 10.1234123412341234);
     CHECK_EQUAL(oss.str(), "10.123412");
 
+    // Test formatting into a fixed size buffer, with snprintf() semantics
+    char buf[8];
+    CHECK_EQUAL(tfm::formatTo(buf, sizeof(buf), "%d:%s", 42, "ab"), 5u);
+    CHECK_EQUAL(std::string(buf), "42:ab");
+    CHECK_EQUAL(tfm::formatTo(buf, sizeof(buf), "%s-%d", "truncated", 10), 12u);
+    CHECK_EQUAL(std::string(buf), "truncat");
+    CHECK_EQUAL(tfm::formatTo(buf, 1, "%d", 100), 3u);
+    CHECK_EQUAL(std::string(buf), "");
+    CHECK_EQUAL(tfm::formatTo(NULL, 0, "%d", 100), 3u);
+    CHECK_EQUAL(tfm::formatTo(buf, sizeof(buf), "% d", 7), 2u);
+    CHECK_EQUAL(std::string(buf), " 7");
+
+    // Test measuring the formatted length
+    CHECK_EQUAL(tfm::formattedSize("%s:%5d|%.2f", "ab", 42, 1.0), 13u);
+    CHECK_EQUAL(tfm::formattedSize("%s", std::string(1000, 'x')), 1000u);
+    CHECK_EQUAL(tfm::formattedSize("no args"), 7u);
+
+    // Test appending to strings, and formatting with custom allocators
+    std::string appendStr = "prefix:";
+    tfm::formatTo(appendStr, "%d:%s", 42, "ab");
+    CHECK_EQUAL(appendStr, "prefix:42:ab");
+    tfm::formatTo(appendStr, "|");
+    CHECK_EQUAL(appendStr, "prefix:42:ab|");
+    // Appending a string to itself, both short and long enough to be
+    // reallocated while it's being read
+    {
+        std::string selfStr = "abc";
+        tfm::formatTo(selfStr, "[%s]", selfStr);
+        CHECK_EQUAL(selfStr, "abc[abc]");
+        selfStr = std::string(31, 'x');
+        tfm::formatTo(selfStr, "%s", selfStr);
+        CHECK_EQUAL(selfStr, std::string(62, 'x'));
+        selfStr = std::string(1000, 'y');
+        tfm::formatTo(selfStr, "<%s>", selfStr);
+        CHECK_EQUAL(selfStr, std::string(1000, 'y') + "<" + std::string(1000, 'y') + ">");
+    }
+#   ifdef TINYFORMAT_USE_VARIADIC_TEMPLATES
+    {
+        int nallocs = 0;
+        CountingAllocator<char> alloc(&nallocs);
+        typedef std::basic_string<char, std::char_traits<char>, CountingAllocator<char> > CountedString;
+        CountedString s = tfm::format(std::allocator_arg, alloc,
+                                      "%s: %d", "a string long enough not to fit in SSO", 42);
+        CHECK_EQUAL(s.c_str(), std::string("a string long enough not to fit in SSO: 42"));
+        CHECK_EQUAL(nallocs > 0, true);
+        int nallocsBefore = nallocs;
+        tfm::formatTo(s, "%s", "more text");
+        CHECK_EQUAL(s.get_allocator().m_count, &nallocs);
+        CHECK_EQUAL(nallocs >= nallocsBefore, true);
+    }
+    {
+        // Large results are presized, so allocated only once
+        int nallocs = 0;
+        CountingAllocator<char> alloc(&nallocs);
+        std::string big(2000, 'x');
+        tfm::format(std::allocator_arg, alloc, "%s|%d|%s|%s", big, 1, big, big);
+        CHECK_EQUAL(nallocs, 1);
+    }
+#   endif
+#   ifdef TINYFORMAT_HAS_PMR
+    {
+        char arena[256];
+        std::pmr::monotonic_buffer_resource resource(arena, sizeof(arena),
+                                                     std::pmr::null_memory_resource());
+        std::pmr::string s = tfm::format(&resource, "%s %d", "a string long enough not to fit in SSO", 7);
+        CHECK_EQUAL(s.c_str(), std::string("a string long enough not to fit in SSO 7"));
+        CHECK_EQUAL(s.data() >= arena && s.data() < arena + sizeof(arena), true);
+        std::pmr::string s2 = tfm::format(std::allocator_arg,
+                                          std::pmr::polymorphic_allocator<char>(&resource),
+                                          "%s", "another string too long for SSO");
+        CHECK_EQUAL(s2.c_str(), std::string("another string too long for SSO"));
+        CHECK_EQUAL(s2.data() >= arena && s2.data() < arena + sizeof(arena), true);
+    }
+#   endif
+
+    // Test that numbers are formatted according to the stream locale, or in
+    // the "C" locale if TINYFORMAT_USE_C_LOCALE is defined.
+    {
+        std::ostringstream locStream;
+        locStream.imbue(std::locale(std::locale::classic(), new GroupingNumpunct()));
+        tfm::format(locStream, "%d|%.2f|%s|%5s", 1234567, 1234.5, "str", 'c');
+#       ifdef TINYFORMAT_USE_C_LOCALE
+        CHECK_EQUAL(locStream.str(), "1234567|1234.50|str|    c");
+#       else
+        CHECK_EQUAL(locStream.str(), "1.234.567|1.234,50|str|    c");
+#       endif
+    }
+
+    // Test pre-parsed format strings
+    {
+        tfm::ParsedFormat parsed;
+        CHECK_EQUAL(parsed.parse("%s: %5.2f%% of %*d"), true);
+        CHECK_EQUAL(parsed.numArgs(), 4);
+        CHECK_EQUAL(tfm::format(parsed, "x", 12.345, 4, 7), "x: 12.35% of    7");
+        EXPECT_ERROR(tfm::format(parsed, "x", 12.345, 4));
+        EXPECT_ERROR(tfm::format(parsed, "x", 12.345, 4, 7, 8));
+        CHECK_EQUAL(parsed.parse("%2$s %1$.*3$f|%2$s"), true);
+        CHECK_EQUAL(tfm::format(parsed, 1.5, "a", 2), "a 1.50|a");
+        EXPECT_ERROR(tfm::format(parsed, 1.5, "a"));
+        std::string error;
+        CHECK_EQUAL(parsed.parse("%d %n", 0, &error), false);
+        CHECK_EQUAL(error, "tinyformat: %n conversion spec not supported");
+        CHECK_EQUAL(parsed.str(), "%2$s %1$.*3$f|%2$s");
+        // Conversions must be compatible with the signature, except that %s
+        // is accepted for anything.  Variable widths must be integers.
+        CHECK_EQUAL(parsed.parse("%s %x", "fd"), true);
+        CHECK_EQUAL(parsed.parse("%*d", "fd"), false);
+        CHECK_EQUAL(parsed.parse("%d", "s"), false);
+    }
+
+    // Test fixed layouts updated in place
+    {
+        tfm::FixedLayout layout;
+        CHECK_EQUAL(layout.parse("[%6.2f|%-5d|%6s] %3s 100%%"), true);
+        CHECK_EQUAL(layout.numSlots(), 4u);
+        CHECK_EQUAL(layout.str(), "[      |     |      ]     100%");
+        layout.set(0, 3.14159);
+        layout.set(1, 42);
+        layout.set(3, MyInt(7));
+        CHECK_EQUAL(layout.str(), "[  3.14|42   |      ]   7 100%");
+        layout.set(1, -1);
+        layout.set(2, shop::Price(5));
+        CHECK_EQUAL(layout.str(), "[  3.14|-1   | $0.05]   7 100%");
+        // Values too wide for their slot are shown as '#'
+        layout.set(0, 12345.678);
+        layout.set(2, "abcdefg");
+        CHECK_EQUAL(std::string(layout.data(), layout.size()), "[######|-1   |######]   7 100%");
+        std::string error;
+        CHECK_EQUAL(layout.parse("%d", &error), false);
+        CHECK_EQUAL(error, "tinyformat: Conversion '%d' in fixed layout has no width");
+        CHECK_EQUAL(layout.parse("%*d", &error), false);
+        CHECK_EQUAL(layout.parse("%1$4d", &error), false);
+        CHECK_EQUAL(error, "tinyformat: Conversion '%1$4d' in fixed layout refers to another argument");
+        CHECK_EQUAL(layout.size(), 30u);
+    }
+
+    // Test format catalogs
+    {
+        tfm::FormatCatalog catalog;
+        catalog.declare("greeting", "sd");
+        catalog.declare("reordered", "sd");
+        catalog.declare("bad_type", "d");
+        catalog.declare("unused", "sd");
+        const char data[] =
+            "# Comment\n"
+            "greeting = Hallo %s, du hast %d Nachrichten\\n\n"
+            "\n"
+            "  reordered=%2$d messages for %1$s\r\n"
+            "bad_type = %f\n"
+            "unused = %s\n"
+            "percent_n = %d%n\n"
+            "mixed = %d %2$d\n"
+            "unterminated = 100%\n"
+            "no_equals\n"
+            "bad_escape = \\q\n"
+            "undeclared = %s\t%s";
+        std::string errors;
+        CHECK_EQUAL(catalog.load(data, sizeof(data) - 1, &errors), false);
+        CHECK_EQUAL(errors,
+            "line 5: bad_type: tinyformat: Argument 1 is used as '%f' but declared as '%d'\n"
+            "line 6: unused: tinyformat: Argument 2 is not used\n"
+            "line 7: percent_n: tinyformat: %n conversion spec not supported\n"
+            "line 8: mixed: tinyformat: Positional argument used after a non-positional one\n"
+            "line 9: unterminated: tinyformat: Conversion spec incorrectly terminated by end of string\n"
+            "line 10: no_equals: expected \"key = format\"\n"
+            "line 11: bad_escape: invalid escape sequence\n");
+        CHECK_EQUAL(catalog.size(), 3u);
+        const tfm::ParsedFormat* greeting = catalog.find("greeting");
+        CHECK_EQUAL(greeting != NULL, true);
+        CHECK_EQUAL(tfm::format(*greeting, "Anna", 3), "Hallo Anna, du hast 3 Nachrichten\n");
+        CHECK_EQUAL(tfm::format(*catalog.find("reordered"), "Anna", 3), "3 messages for Anna");
+        CHECK_EQUAL(tfm::format(*catalog.find("undeclared"), 1, 2), "1\t2");
+        CHECK_EQUAL(catalog.find("bad_type") == NULL, true);
+        // A bad update leaves the existing entry in place
+        CHECK_EQUAL(catalog.add("greeting", "Hallo %s"), false);
+        CHECK_EQUAL(catalog.find("greeting"), greeting);
+        CHECK_EQUAL(catalog.find("greeting")->str(), "Hallo %s, du hast %d Nachrichten\n");
+        CHECK_EQUAL(catalog.loadFile("nonexistent_file.txt"), false);
+    }
+
+    // Test scanning, with the same format strings as formatting
+    {
+        int id = 0;
+        double price = 0;
+        std::string client;
+        const char* orderFmt = "order %d filled at %.2f for %s\n";
+        const std::string order = tfm::format(orderFmt, -42, 3.25, "bob");
+        CHECK_EQUAL(tfm::scan(order, orderFmt, id, price, client), 3);
+        CHECK_EQUAL(tfm::format(orderFmt, id, price, client), order);
+        // Whitespace matches any whitespace, and numbers skip it
+        CHECK_EQUAL(tfm::scan("order\t7   filled at\n 1e2for x", orderFmt, id, price, client), 3);
+        CHECK_EQUAL(id, 7);
+        CHECK_EQUAL(price, 100.0);
+        // Scanning stops at the first mismatch
+        CHECK_EQUAL(tfm::scan("order 8 filled for y", orderFmt, id, price, client), 1);
+        CHECK_EQUAL(id, 8);
+        CHECK_EQUAL(client, "x");
+        CHECK_EQUAL(tfm::scan("order x", orderFmt, id, price, client), 0);
+        CHECK_EQUAL(id, 8);
+        // Positional arguments, widths and "%%"
+        int year = 0, month = 0, day = 0, percent = 0;
+        CHECK_EQUAL(tfm::scan("20240917 50%", "%3$4d%2$2d%1$2d %4$d%%", day, month, year, percent), 4);
+        CHECK_EQUAL(tfm::format("%d-%d-%d %d", year, month, day, percent), "2024-9-17 50");
+        // Numbers are read according to the conversion, and must fit
+        unsigned int hex = 0;
+        unsigned char small = 0;
+        long long big = 0;
+        void* ptr = 0;
+        CHECK_EQUAL(tfm::scan("0xff 017 -9223372036854775808 0x1234", "%x %i %lld %p", hex, small, big, ptr), 4);
+        CHECK_EQUAL(hex, 255u);
+        CHECK_EQUAL(small, 15);
+        CHECK_EQUAL(big, (std::numeric_limits<long long>::min)());
+        CHECK_EQUAL(ptr, (void*)0x1234);
+        CHECK_EQUAL(tfm::scan("256", "%d", small), 0);
+        CHECK_EQUAL(tfm::scan("-1", "%d", hex), 0);
+        CHECK_EQUAL(tfm::scan("99999999999999999999", "%d", big), 0);
+        // Characters, bools and char arrays
+        char c = 0, sc = 0;
+        bool flag = false;
+        char word[4];
+        CHECK_EQUAL(tfm::scan(" x true ab", "%c%s %s %s", c, sc, flag, word), 4);
+        CHECK_EQUAL(c, ' ');
+        CHECK_EQUAL(sc, 'x');
+        CHECK_EQUAL(flag, true);
+        CHECK_EQUAL(std::string(word), "ab");
+        const char* stop = 0;
+        const char input[] = "abcdef|";
+        CHECK_EQUAL(tfm::vscan(input, input + 7, "%s", tfm::makeScanList(word), &stop), 1);
+        CHECK_EQUAL(std::string(word), "abc");
+        CHECK_EQUAL(std::string(stop), "def|");
+        CHECK_EQUAL(tfm::scan("ab cd", "%3c", client), 1);
+        CHECK_EQUAL(client, "ab ");
+        // Floating point values read back exactly what was written
+        const double doubles[] = { 0.1, -2.5e-300, 123456789012345678.0, 5e-324,
+                                   1.7976931348623157e308, 3.0e22, 0.000123 };
+        bool doublesOk = true;
+        for (std::size_t i = 0; i < sizeof(doubles)/sizeof(doubles[0]); ++i) {
+            double d = 0;
+            doublesOk = doublesOk && tfm::scan(tfm::format("%.17g", doubles[i]), "%g", d) == 1 &&
+                        d == doubles[i];
+        }
+        CHECK_EQUAL(doublesOk, true);
+        float f = 0;
+        long double ld = 0;
+        double d2 = 0;
+        double d3 = 1;
+        CHECK_EQUAL(tfm::scan(tfm::format("%a %.3f", 1.5, 0.25), "%a %f", price, f), 2);
+        CHECK_EQUAL(price, 1.5);
+        CHECK_EQUAL(f, 0.25f);
+        CHECK_EQUAL(tfm::scan("-inf 2.5", "%f %Lf", price, ld), 2);
+        CHECK_EQUAL(price, -std::numeric_limits<double>::infinity());
+        CHECK_EQUAL(ld, 2.5L);
+        // Out of range numbers read as infinity or zero, and "0x" without
+        // hex digits as 0, with from_chars() or strtod()
+        CHECK_EQUAL(tfm::scan("1e400 -1e400 1e-400 1e-5000 1e39", "%f %f %f %Lf %f",
+                              price, d2, d3, ld, f), 5);
+        CHECK_EQUAL(price, std::numeric_limits<double>::infinity());
+        CHECK_EQUAL(d2, -std::numeric_limits<double>::infinity());
+        CHECK_EQUAL(d3, 0.0);
+        CHECK_EQUAL(ld, 0.0L);
+        CHECK_EQUAL(f, std::numeric_limits<float>::infinity());
+        CHECK_EQUAL(tfm::scan("0x1p99999 0xz", "%a %a%s", price, d2, client), 3);
+        CHECK_EQUAL(price, std::numeric_limits<double>::infinity());
+        CHECK_EQUAL(d2, 0.0);
+        CHECK_EQUAL(client, "xz");
+        // The argument list must match the format
+        EXPECT_ERROR(tfm::scan("1 2", "%d %d", id));
+        EXPECT_ERROR(tfm::scan("1 2", "%d", id, day));
+        EXPECT_ERROR(tfm::scan("1", "%*d", id, day));
+        EXPECT_ERROR(tfm::scan("1 2", "%d %1$d", id, day));
+        CHECK_EQUAL(tfm::scan("1 2", "%d %d", id, day), 2);
+    }
+
+    // Test pre-parsed scan formats
+    {
+        tfm::ScanFormat scanFmt;
+        CHECK_EQUAL(scanFmt.parse("%2$s = %1$d%% done"), true);
+        CHECK_EQUAL(scanFmt.numArgs(), 2);
+        int done = 0;
+        std::string task;
+        CHECK_EQUAL(tfm::scan("build=75% done", scanFmt, done, task), 1);
+        CHECK_EQUAL(task, "build=75%");
+        CHECK_EQUAL(tfm::scan("build = 75%done", scanFmt, done, task), 2);
+        CHECK_EQUAL(tfm::format("%s %d", task, done), "build 75");
+        EXPECT_ERROR(tfm::scan("x = 1", scanFmt, done));
+        std::string error;
+        CHECK_EQUAL(scanFmt.parse("%d %.*f", &error), false);
+        CHECK_EQUAL(error, "tinyformat: Conversion '%.*f' has a variable width or precision, "
+                           "which can't be scanned");
+        CHECK_EQUAL(scanFmt.parse("%d %1$d", &error), false);
+        CHECK_EQUAL(scanFmt.str(), "%2$s = %1$d%% done");
+    }
+
+    // Test formatting to sinks
+    {
+        std::string str = "prefix:";
+        {
+            tfm::StringSink sink(str);
+            tfm::format(sink, "%s|%-300d|", "ab", 42);
+            tfm::format(sink, "%s", MyInt(7));
+        }
+        CHECK_EQUAL(str, "prefix:ab|42" + std::string(298, ' ') + "|7");
+        tfm::StringSink sink(str);
+        tfm::format(sink, "%s", "more");
+        sink.finish();
+        CHECK_EQUAL(str.size(), 7u + 305u + 4u);
+
+        char buf[10];
+        tfm::FixedBufferSink bufSink(buf, sizeof(buf));
+        tfm::format(bufSink, "%d:%s", 100, MyInt(5));
+        tfm::format(bufSink, "%5s", "x");
+        CHECK_EQUAL(bufSink.finish(), 10u);
+        CHECK_EQUAL(std::string(buf), "100:5    ");
+
+        SmallWindowSink smallSink;
+        tfm::format(smallSink, "%s%2d", "ab", 5);
+        CHECK_EQUAL(smallSink.overflows(), 0);
+        tfm::format(smallSink, "%s|%-6s|", "defghi", MyInt(1));
+        CHECK_EQUAL(smallSink.str(), "ab 5defghi|1     |");
+        CHECK_EQUAL(smallSink.overflows() > 0, true);
+
+        // Numbers in a stream with a custom locale are formatted through the
+        // stream, even when mixed with native output
+        std::ostringstream locStream;
+        locStream.imbue(std::locale(std::locale::classic(), new GroupingNumpunct()));
+        tfm::OstreamSink streamSink(locStream);
+        tfm::format(streamSink, "%s %d %s", "a", 1000, MyInt(2));
+        CHECK_EQUAL(streamSink.flush(), true);
+#       ifdef TINYFORMAT_USE_C_LOCALE
+        CHECK_EQUAL(locStream.str(), "a 1000 2");
+#       else
+        CHECK_EQUAL(locStream.str(), "a 1.000 2");
+#       endif
+
+        // Checking the stream locale doesn't write out the buffered output
+        CountingStreambuf sinkBuf;
+        std::ostream countedStream(&sinkBuf);
+        {
+            tfm::OstreamSink countedSink(countedStream);
+            tfm::format(countedSink, "%s %d", "a", 1);
+            tfm::format(countedSink, " %.1f", 2.5);
+            CHECK_EQUAL(sinkBuf.writes, 0);
+        }
+        CHECK_EQUAL(sinkBuf.writes, 1);
+        CHECK_EQUAL(sinkBuf.str, "a 1 2.5");
+
+        // Failed writes set badbit on the stream, and nothing is written to
+        // a stream which has already failed
+        TinyStreambuf tinyBuf;
+        std::ostream tinyStream(&tinyBuf);
+        tfm::format(tinyStream, "%s%d", "abc", 1234);
+        CHECK_EQUAL(tinyStream.bad(), true);
+        CHECK_EQUAL(tinyBuf.str(), "abc1");
+        std::ostringstream failedStream;
+        failedStream.setstate(std::ios::failbit);
+        tfm::format(failedStream, "%d %s", 1, MyInt(2));
+        CHECK_EQUAL(failedStream.str(), "");
+    }
+    // Tee output to several sinks
+    {
+        std::string str1, str2;
+        char buf[16];
+        {
+            tfm::StringSink sink1(str1);
+            tfm::StringSink sink2(str2);
+            tfm::FixedBufferSink bufSink(buf, sizeof(buf));
+            tfm::TeeSink tee(sink1, sink2, bufSink);
+            tfm::format(tee, "%s|%-600d|", "ab", 42);
+            tfm::format(tee, "%.2f %s", 1.5, MyInt(7));
+            tee.flush();
+            CHECK_EQUAL(bufSink.finish(), 604u + 6u);
+        }
+        const std::string expected = "ab|42" + std::string(598, ' ') + "|1.50 7";
+        CHECK_EQUAL(str1, expected);
+        CHECK_EQUAL(str2, expected);
+        CHECK_EQUAL(std::string(buf), expected.substr(0, 15));
+        SmallWindowSink smallSinks[4];
+        tfm::Sink* sinks[] = {&smallSinks[0], &smallSinks[1], &smallSinks[2], &smallSinks[3]};
+        {
+            tfm::TeeSink tee(sinks, 4);
+            tfm::format(tee, "%s=%d", "x", 1);
+        }
+        CHECK_EQUAL(smallSinks[3].str(), "x=1");
+    }
+    // Argument lists built at runtime hold copies of their arguments
+    {
+        tfm::DynamicFormatList args;
+        char name[] = "abc";
+        args.push(name).push(std::string("def")).push(6).push(42).push(1.5)
+            .push(MyInt(7)).push(shop::Price(250));
+        name[0] = 'x';
+        CHECK_EQUAL(args.size(), 7);
+        std::string dynStr;
+        tfm::vformatTo(dynStr, "%s %s|%*d|%.2f %s %s", args);
+        CHECK_EQUAL(dynStr, "abc def|    42|1.50 7 $2.50");
+        std::ostringstream dynStream;
+        tfm::vformat(dynStream, "%2$s %1$s", args);
+        CHECK_EQUAL(dynStream.str(), "def abc");
+        args.clear();
+        CHECK_EQUAL(args.size(), 0);
+        const std::string longStr(2000, 'y');
+        for (int i = 0; i < 20; ++i)
+            args.push(i);
+        args.push(longStr).push((const char*)0);
+        args.pushRef(name);
+        dynStr.clear();
+        tfm::vformatTo(dynStr, "%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d%d %.3s %s %s", args);
+        CHECK_EQUAL(dynStr, "012345678910111213141516171819 yyy " +
+                            tfm::format("%s", (const char*)0) + " xbc");
+        EXPECT_ERROR(tfm::vformatTo(dynStr, "%d", args));
+#       if __cplusplus >= 201103L
+        // Over-aligned values are aligned in the pool
+        args.clear();
+        args.push('a').push(AlignedInt{1}).push(std::string(1000, 'z'))
+            .push(AlignedInt{2}).push(AlignedInt{3});
+        dynStr.clear();
+        tfm::vformatTo(dynStr, "%c%s%.1s%s%s", args);
+        CHECK_EQUAL(dynStr, "a1z23");
+#       endif
+    }
+
+#   ifdef TINYFORMAT_HAS_SHM_RING
+    // Messages written to a shared memory ring are formatted by the reader
+    {
+        const std::string ringName = tfm::format("/tinyformat_test_%d", getpid());
+        tfm::ShmRingWriter writer;
+        CHECK_EQUAL(writer.create(ringName.c_str(), 1024), true);
+        tfm::ShmRingReader reader;
+        std::string error;
+        CHECK_EQUAL(reader.open("/tinyformat_test_missing", &error), false);
+        CHECK_EQUAL(error, "/tinyformat_test_missing: could not open shared memory");
+        CHECK_EQUAL(reader.open(ringName.c_str()), true);
+        const char* str = "str";
+        char chars[] = "chars";
+        CHECK_EQUAL(writer.write("%s %s %s %s|%c %d %u %lld %.2f %Lg %5s|%x\n", str, chars,
+                                 std::string("string"), (const char*)0, 'c', -1, 2u,
+                                 -3LL, 4.5f, 6.5L, true, (unsigned char)255), true);
+        CHECK_EQUAL(writer.write("%*d\n", 4, 7), true);
+        std::string ringStr;
+        CHECK_EQUAL(readRing(reader, ringStr), true);
+        CHECK_EQUAL(readRing(reader, ringStr), true);
+        CHECK_EQUAL(readRing(reader, ringStr), false);
+        CHECK_EQUAL(ringStr, "str chars string " + tfm::format("%s", (const char*)0) +
+                             "|c -1 2 -3 4.50 6.5  true|ff\n   7\n");
+        // A full ring drops messages rather than waiting for the reader,
+        // and wraps around once they've been read
+        int written = 0;
+        while (writer.write("message %d %s\n", written, std::string(40, 'x')))
+            ++written;
+        CHECK_EQUAL(writer.dropped(), 1u);
+        ringStr.clear();
+        std::string expectedStr;
+        for (int i = 0; i < written; ++i) {
+            readRing(reader, ringStr);
+            expectedStr += tfm::format("message %d %s\n", i, std::string(40, 'x'));
+        }
+        CHECK_EQUAL(ringStr, expectedStr);
+        for (int i = 0; i < 100; ++i) {
+            CHECK_EQUAL(writer.write("%d\n", i), true);
+            ringStr.clear();
+            CHECK_EQUAL(readRing(reader, ringStr), true);
+            CHECK_EQUAL(ringStr, tfm::format("%d\n", i));
+        }
+        CHECK_EQUAL(reader.dropped(), 1u);
+        // A reader which attaches later is sent the format strings again
+        tfm::ShmRingReader reader2;
+        CHECK_EQUAL(reader2.open(ringName.c_str()), true);
+        writer.write("%d\n", 5);
+        ringStr.clear();
+        CHECK_EQUAL(readRing(reader2, ringStr), true);
+        CHECK_EQUAL(ringStr, "5\n");
+        CHECK_EQUAL(reader2.done(), false);
+        writer.close();
+        CHECK_EQUAL(reader2.done(), true);
+        CHECK_EQUAL(tfm::ShmRingWriter::remove(ringName.c_str()), true);
+    }
+    // Messages with a corrupt argument tag are skipped and counted
+    {
+        const std::string ringName = tfm::format("/tinyformat_test_corrupt_%d", getpid());
+        tfm::ShmRingWriter writer;
+        CHECK_EQUAL(writer.create(ringName.c_str(), 1024), true);
+        tfm::ShmRingReader reader;
+        CHECK_EQUAL(reader.open(ringName.c_str()), true);
+        writer.write("%d\n", 1);
+        writer.write("%d\n", 2);
+        const int fd = shm_open(ringName.c_str(), O_RDWR, 0);
+        CHECK_EQUAL(fd >= 0, true);
+        const std::size_t mapSize = tfm::detail::shmDataOffset + 1024;
+        void* addr = mmap(0, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        CHECK_EQUAL(addr != MAP_FAILED, true);
+        // The format record comes first, then the first message
+        char* data = static_cast<char*>(addr) + tfm::detail::shmDataOffset;
+        tfm::detail::ShmRecordHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        data[header.size + sizeof(header)] = static_cast<char>(200);
+        munmap(addr, mapSize);
+        std::string ringStr;
+        CHECK_EQUAL(readRing(reader, ringStr), true);
+        CHECK_EQUAL(ringStr, "2\n");
+        CHECK_EQUAL(reader.dropped(), 1u);
+        tfm::ShmRingWriter::remove(ringName.c_str());
+    }
+    // ... including when the writer is in another process
+    {
+        const std::string ringName = tfm::format("/tinyformat_test_fork_%d", getpid());
+        const int numMessages = 5000;
+        int attached[2];
+        CHECK_EQUAL(pipe(attached), 0);
+        pid_t child = fork();
+        if (child == 0) {
+            tfm::ShmRingWriter writer;
+            char c = 0;
+            if (!writer.create(ringName.c_str(), 4096) || read(attached[0], &c, 1) != 1)
+                _exit(1);
+            for (int i = 0; i < numMessages; ++i)
+                writer.write("%d %s\n", i, "abcdefghijklmnopqrstuvwxyz");
+            writer.close();
+            _exit(0);
+        }
+        tfm::ShmRingReader reader;
+        bool opened = false;
+        for (int tries = 0; tries < 5000 && !opened; ++tries) {
+            opened = reader.open(ringName.c_str());
+            if (!opened)
+                usleep(1000);
+        }
+        CHECK_EQUAL(opened, true);
+        CHECK_EQUAL(write(attached[1], "x", 1), 1);
+        close(attached[0]);
+        close(attached[1]);
+        int received = 0;
+        int last = -1;
+        bool inOrder = true;
+        std::string ringStr;
+        while (opened && !reader.done()) {
+            ringStr.clear();
+            if (!readRing(reader, ringStr))
+                continue;
+            int i = atoi(ringStr.c_str());
+            inOrder = inOrder && i > last && ringStr == tfm::format("%d abcdefghijklmnopqrstuvwxyz\n", i);
+            last = i;
+            ++received;
+        }
+        int status = -1;
+        waitpid(child, &status, 0);
+        tfm::ShmRingWriter::remove(ringName.c_str());
+        CHECK_EQUAL(status, 0);
+        CHECK_EQUAL(inOrder, true);
+        CHECK_EQUAL(received + reader.dropped(), (unsigned)numMessages);
+    }
+#   endif
+
+    // Chunked output, resumed part way through literals and arguments
+    {
+        // The list refers to the arguments, so they mustn't be temporaries
+        const std::string longStr(300, 'x');
+        const int width = 12, num = 42;
+        const double pi = 3.14159;
+        const MyInt myInt(123);
+        const shop::Price price(-1234);
+        const char* chunkFmt = "a%%b %s|%-*d|%5.2f|%s|%.3s %s end";
+        tfm::FormatListRef chunkList = tfm::makeFormatList(longStr, width, num, pi, myInt,
+                                                           "truncated", price);
+        std::string expected;
+        tfm::vformatTo(expected, chunkFmt, chunkList);
+        bool chunksOk = true;
+        for (std::size_t chunkSize = 1; chunkSize <= expected.size() + 1; ++chunkSize) {
+            tfm::ChunkedFormatter formatter(chunkFmt, chunkList);
+            std::string result;
+            std::vector<char> chunk(chunkSize);
+            int calls = 0;
+            while (!formatter.done() && calls++ <= 1000) {
+                std::size_t n = formatter.next(&chunk[0], chunkSize);
+                if (n != chunkSize && !formatter.done())
+                    chunksOk = false;
+                result.append(&chunk[0], n);
+            }
+            if (result != expected)
+                chunksOk = false;
+        }
+        CHECK_EQUAL(chunksOk, true);
+        char chunk[8];
+        tfm::FormatListRef emptyList = tfm::makeFormatList();
+        tfm::ChunkedFormatter emptyFormatter("", emptyList);
+        CHECK_EQUAL(emptyFormatter.next(chunk, sizeof(chunk)), 0u);
+        CHECK_EQUAL(emptyFormatter.done(), true);
+    }
+#   if defined(TINYFORMAT_HAS_FD_SINK) && !defined(_WIN32)
+    {
+        FILE* file = tmpfile();
+        {
+            tfm::FdSink sink(fileno(file));
+            tfm::format(sink, "%s:%d\n", "fd", 1);
+            tfm::format(sink, "%600s\n", MyInt(2));
+            CHECK_EQUAL(sink.flush(), true);
+        }
+        char contents[1000] = {0};
+        std::rewind(file);
+        std::size_t len = std::fread(contents, 1, sizeof(contents), file);
+        std::fclose(file);
+        CHECK_EQUAL(std::string(contents, len), "fd:1\n" + std::string(599, ' ') + "2\n");
+    }
+#   endif
+
     // Test formatting a custom object
     MyInt myobj(42);
     CHECK_EQUAL(tfm::format("myobj: %s", myobj), "myobj: 42");
 
+    // Byte ranges in hex
+    {
+        const unsigned char packet[] = {0x0a, 0x1b, 0x2c, 0x3d, 0x4e, 0x5f, 0xff};
+        CHECK_EQUAL(tfm::format("%s|%X", tfm::hexbytes(packet, 7), tfm::hexbytes(packet, 3)),
+                    "0a1b2c3d4e5fff|0A1B2C");
+        CHECK_EQUAL(tfm::format("%s", tfm::hexbytes(packet, 7, 2, ':')), "0a1b:2c3d:4e5f:ff");
+        CHECK_EQUAL(tfm::format("[%.3s|%.0x|%8.2x|%-6.2s]", tfm::hexbytes(packet, 7, 1),
+                                tfm::hexbytes(packet, 7), tfm::hexbytes(packet, 7),
+                                tfm::hexbytes(packet, 1)),
+                    "[0a 1b 2c||    0a1b|0a    ]");
+        CHECK_EQUAL(tfm::format("%s", tfm::hexbytes(packet, 0, 2)), "");
+        // Output longer than the internal encoding buffer
+        char big[300];
+        for (int i = 0; i < 300; ++i)
+            big[i] = '\x5a';
+        std::string expected = "5a5a5a5a";
+        for (int i = 1; i < 75; ++i)
+            expected += " 5a5a5a5a";
+        CHECK_EQUAL(tfm::format("%s", tfm::hexbytes(big, sizeof(big), 4)), expected);
+        std::ostringstream hexStream;
+        hexStream << tfm::hexbytes(packet, 2);
+        CHECK_EQUAL(hexStream.str(), "0a1b");
+    }
+
+#   ifdef TINYFORMAT_HAS_CHRONO
+    // Timestamps
+    {
+        using std::chrono::milliseconds;
+        std::chrono::system_clock::time_point t =
+            std::chrono::system_clock::from_time_t(1700000000) + milliseconds(123);
+        CHECK_EQUAL(tfm::format("[%s]", tfm::timestamp(t, "%Y-%m-%d %H:%M:%S.%3f", true)),
+                    "[2023-11-14 22:13:20.123]");
+        // Cached second, different fraction
+        CHECK_EQUAL(tfm::format("%s", tfm::timestamp(t + milliseconds(456), "%Y-%m-%d %H:%M:%S.%3f", true)),
+                    "2023-11-14 22:13:20.579");
+        CHECK_EQUAL(tfm::format("%s|%s", tfm::timestamp(t, "%H:%M:%S,%fZ", true),
+                                tfm::timestamp(t + milliseconds(1000), "%H:%M:%S %%f %1f", true)),
+                    "22:13:20,123000Z|22:13:21 %f 1");
+        CHECK_EQUAL(tfm::format("%s|%s", tfm::timestamp(t, "%9f", true),
+                                tfm::timestamp(t, "%H:%M", true)),
+                    "123000000|22:13");
+        // Padding and truncation are applied as usual
+        CHECK_EQUAL(tfm::format("%10s|%.10s", tfm::timestamp(t, "%H:%M", true),
+                                tfm::timestamp(t, "%Y-%m-%d %H:%M", true)),
+                    "     22:13|2023-11-14");
+        // Before 1970
+        CHECK_EQUAL(tfm::format("%s", tfm::timestamp(std::chrono::system_clock::from_time_t(0) -
+                                                     milliseconds(750), "%Y-%m-%d %H:%M:%S.%3f", true)),
+                    "1969-12-31 23:59:59.250");
+        // Patterns with output longer than the initial strftime() buffer
+        const std::string longText(300, 'a');
+        const std::string longPattern = longText + " %Y";
+        const std::string longFracPattern = longText + " %3f %Y";
+        CHECK_EQUAL(tfm::format("[%s]", tfm::timestamp(t, longPattern.c_str(), true)),
+                    "[" + longText + " 2023]");
+        CHECK_EQUAL(tfm::format("[%s]", tfm::timestamp(t, longFracPattern.c_str(), true)),
+                    "[" + longText + " 123 2023]");
+    }
+#   endif
+
+    // Ranges, with the conversion applied to each element
+    {
+        std::vector<double> v;
+        v.push_back(1);
+        v.push_back(2.5);
+        v.push_back(3.14159);
+        CHECK_EQUAL(tfm::format("%.2f", tfm::range(v)), "1.00, 2.50, 3.14");
+        CHECK_EQUAL(tfm::format("%5.1f|", tfm::range(v).brackets("[", "]").separator(";")),
+                    "[  1.0;  2.5;  3.1]|");
+        CHECK_EQUAL(tfm::format("%s", tfm::range(v.begin(), v.begin())), "");
+        CHECK_EQUAL(tfm::format("%g", tfm::range(v).brackets("{", "}").limit(2)),
+                    "{1, 2.5, ...}");
+        CHECK_EQUAL(tfm::format("%g", tfm::range(v).limit(0)), "...");
+        const char* names[] = {"alpha", "beta"};
+        CHECK_EQUAL(tfm::format("%-6.3s|", tfm::range(names).separator("|")), "alp   |bet   |");
+        int ints[] = {255, 16};
+        CHECK_EQUAL(tfm::format("%#x %s", tfm::range(ints), tfm::range(ints)), "0xff, 0x10 255, 16");
+        MyInt objs[] = {MyInt(1), MyInt(2)};
+        shop::Price prices[] = {shop::Price(100), shop::Price(250)};
+        CHECK_EQUAL(tfm::format("%3s / %s", tfm::range(objs), tfm::range(prices)),
+                    "  1,   2 / $1.00, $2.50");
+        std::ostringstream rangeStream;
+        tfm::format(rangeStream, "%d: %s", 2, tfm::range(v).brackets("(", ")"));
+        CHECK_EQUAL(rangeStream.str(), "2: (1, 2.5, 3.14159)");
+    }
+
+#   ifdef TINYFORMAT_HAS_LAZY
+    // Lazy arguments are evaluated once, and only when formatted
+    {
+        int calls = 0;
+        CHECK_EQUAL(tfm::format("%1$s-%2$d-%1$s", tfm::lazy([&]{ ++calls; return std::string("ab"); }), 7),
+                    "ab-7-ab");
+        CHECK_EQUAL(calls, 1);
+        CHECK_EQUAL(tfm::format("%*.*f|%s|%5s", tfm::lazy([&]{ ++calls; return 8; }), 2, 3.14159,
+                                tfm::lazy([&]{ ++calls; return MyInt(3); }),
+                                tfm::lazy([&]{ ++calls; return shop::Price(250); })),
+                    "    3.14|3|$2.50");
+        CHECK_EQUAL(calls, 4);
+        int value = 1;
+        auto later = tfm::lazy([&]{ ++calls; return value; });
+        tfm::FormatListRef list = tfm::makeFormatList(later);
+        value = 2;
+        CHECK_EQUAL(calls, 4);
+        std::string lazyStr;
+        tfm::vformatTo(lazyStr, "%d", list);
+        CHECK_EQUAL(lazyStr, "2");
+        CHECK_EQUAL(tfm::format("%s", tfm::range(&later, &later + 1)), "2");
+        CHECK_EQUAL(calls, 5);
+    }
+#   endif
+
+    // Types with a tinyformatTo() function write straight to the output
+    CHECK_EQUAL(tfm::format("%s|%d|%s", shop::Price(1234), shop::Price(5), 1),
+                "$12.34|0.05|1");
+    CHECK_EQUAL(tfm::format("%.3s|%s", shop::Price(1234), shop::Price(99)), "$12|$0.99");
+    // ... and are padded by tinyformat, with zeros after any sign
+    CHECK_EQUAL(tfm::format("%8s|%-8s|%6.3s", shop::Price(1234), shop::Price(-5), shop::Price(99)),
+                "  $12.34|-$0.05  |   $0.");
+    CHECK_EQUAL(tfm::format("%08d|%08d", shop::Price(-1234), shop::Price(1234)),
+                "-0012.34|00012.34");
+    {
+        std::ostringstream priceStream;
+        tfm::format(priceStream, "%s %s", MyInt(1), shop::Price(250));
+        CHECK_EQUAL(priceStream.str(), "1 $2.50");
+    }
+
     // Test that interface wrapping works correctly
     TestWrap wrap;
     CHECK_EQUAL(wrap.error(10, "someformat %s:%d:%d", "asdf", 2, 4),
@@ -335,6 +1267,65 @@ int unitTests()
     std::cout.rdbuf(coutBuf); // restore buffer
     CHECK_EQUAL(coutCapture.str(), "printf test 1\nprintfln test 1\n");
 
+    // Each line, including long ones, is written in one piece
+    CountingStreambuf lineBuf;
+    coutBuf = std::cout.rdbuf(&lineBuf);
+    tfm::printfln("%s %d", "line", 1);
+    tfm::printfln("%600s", MyInt(2));
+    std::cout.rdbuf(coutBuf);
+    CHECK_EQUAL(lineBuf.writes, 2);
+    CHECK_EQUAL(lineBuf.str, "line 1\n" + std::string(599, ' ') + "2\n");
+
+    // Buffered sinks write whole messages once the size limit is reached
+    CountingStreambuf batchBuf;
+    {
+        std::ostream batchStream(&batchBuf);
+        tfm::BufferedOstreamSink sink(batchStream, 16);
+        tfm::format(sink, "%s %d\n", "a", 1);
+        sink.endMessage();
+        CHECK_EQUAL(batchBuf.writes, 0);
+        tfm::format(sink, "%s %d\n", "bcdefghijk", 2);
+        sink.endMessage();
+        CHECK_EQUAL(batchBuf.writes, 1);
+        CHECK_EQUAL(batchBuf.str, "a 1\nbcdefghijk 2\n");
+        tfm::format(sink, "%300s\n", MyInt(3));
+        tfm::format(sink, "%s", 4);
+        sink.endMessage();
+        CHECK_EQUAL(batchBuf.writes, 2);
+        tfm::format(sink, "%s", "unfinished");
+    }
+    CHECK_EQUAL(batchBuf.writes, 3);
+    CHECK_EQUAL(batchBuf.str, "a 1\nbcdefghijk 2\n" + std::string(299, ' ') + "3\n4unfinished");
+    // ... formatted in the locale of the stream, as user defined types are,
+    // without flushing a stream tied to it for each argument
+    CountingStreambuf tiedBuf;
+    std::ostream tiedStream(&tiedBuf);
+    std::ostringstream batchLocStream;
+    batchLocStream.imbue(std::locale(std::locale::classic(), new GroupingNumpunct()));
+    batchLocStream.tie(&tiedStream);
+    {
+        tfm::BufferedOstreamSink sink(batchLocStream);
+        tfm::format(sink, "%d|%.1f|%s|%7s", 1234567, 1234.5, MyInt(12345), MyInt(1000));
+        CHECK_EQUAL(tiedBuf.syncs, 0);
+    }
+#   ifdef TINYFORMAT_USE_C_LOCALE
+    CHECK_EQUAL(batchLocStream.str(), "1234567|1234.5|12.345|  1.000");
+#   else
+    CHECK_EQUAL(batchLocStream.str(), "1.234.567|1.234,5|12.345|  1.000");
+#   endif
+#   ifdef TINYFORMAT_HAS_CHRONO
+    // ... or the time limit
+    CountingStreambuf timedBuf;
+    {
+        std::ostream timedStream(&timedBuf);
+        tfm::BufferedOstreamSink sink(timedStream, 4096,
+                                      tfm::BufferedOstreamSink::Clock::duration::zero());
+        tfm::format(sink, "%d\n", 1);
+        sink.endMessage();
+        CHECK_EQUAL(timedBuf.str, "1\n");
+    }
+#   endif
+
     return nfailed;
 }
 
@@ -0,0 +1,136 @@
+// Compare ways of writing lines to a shared stream from many threads.
+//
+// std::cout is given a stream buffer guarded by a mutex, standing in for the
+// lock taken by a real stdout or log file buffer.  For each output method
+// this reports the throughput, the number of times the lock was taken per
+// line, the time it was held and waited for, and the number of lines which
+// were torn apart by output from other threads.
+//
+// Usage: tinyformat_thread_speed_test [nthreads [nlines]]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tinyformat.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Stream buffer appending to a string under a mutex, recording how long the
+// mutex is waited for and held.
+class LockedStreambuf : public std::streambuf
+{
+    public:
+        LockedStreambuf() : locks(0), waitTime(0), holdTime(0) { }
+
+        std::string str;
+        long locks;
+        Clock::duration waitTime;
+        Clock::duration holdTime;
+
+    protected:
+        virtual std::streamsize xsputn(const char* s, std::streamsize n)
+        {
+            Clock::time_point request = Clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Clock::time_point start = Clock::now();
+            str.append(s, static_cast<std::size_t>(n));
+            ++locks;
+            waitTime += start - request;
+            holdTime += Clock::now() - start;
+            return n;
+        }
+
+        virtual int_type overflow(int_type c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+            return c;
+        }
+
+    private:
+        std::mutex m_mutex;
+};
+
+#define LINE_FORMAT "thread %d line %d: %s %.3f 0x%08x"
+
+void writeLines(const std::string& which, int thread, int nlines)
+{
+    if (which == "stream") {
+        // What printfln() used to do: format, then a separate newline
+        for (int i = 0; i < nlines; ++i) {
+            tfm::format(std::cout, LINE_FORMAT, thread, i, "status", i*0.5, i*2654435761u);
+            std::cout << '\n';
+        }
+    }
+    else if (which == "printfln") {
+        for (int i = 0; i < nlines; ++i)
+            tfm::printfln(LINE_FORMAT, thread, i, "status", i*0.5, i*2654435761u);
+    }
+    else if (which == "buffered") {
+        tfm::BufferedOstreamSink sink(std::cout);
+        for (int i = 0; i < nlines; ++i) {
+            tfm::format(sink, LINE_FORMAT "\n", thread, i, "status", i*0.5, i*2654435761u);
+            sink.endMessage();
+        }
+    }
+}
+
+// Count lines which don't consist of exactly one whole formatted line
+long countTornLines(const std::string& output)
+{
+    long torn = 0;
+    std::size_t begin = 0;
+    while (begin < output.size()) {
+        std::size_t end = output.find('\n', begin);
+        if (end == std::string::npos)
+            end = output.size();
+        std::string line = output.substr(begin, end - begin);
+        int thread = 0, i = 0;
+        if (std::sscanf(line.c_str(), "thread %d line %d:", &thread, &i) != 2 ||
+            line != tfm::format(LINE_FORMAT, thread, i, "status", i*0.5, i*2654435761u))
+            ++torn;
+        begin = end + 1;
+    }
+    return torn;
+}
+
+void speedTest(const std::string& which, int nthreads, int nlines)
+{
+    LockedStreambuf buf;
+    buf.str.reserve(static_cast<std::size_t>(nthreads)*nlines*64);
+    std::streambuf* coutBuf = std::cout.rdbuf(&buf);
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t)
+        threads.push_back(std::thread(writeLines, which, t, nlines));
+    for (std::size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout.rdbuf(coutBuf);
+
+    const double totalLines = double(nthreads)*nlines;
+    std::printf("%-9s %8.0f klines/s  %5.2f locks/line  hold %6.1f ns/line  "
+                "wait %7.1f ns/line  %ld torn\n",
+                which.c_str(), totalLines/seconds/1000, buf.locks/totalLines,
+                std::chrono::duration<double, std::nano>(buf.holdTime).count()/totalLines,
+                std::chrono::duration<double, std::nano>(buf.waitTime).count()/totalLines,
+                countTornLines(buf.str));
+}
+
+int main(int argc, char* argv[])
+{
+    int nthreads = argc >= 2 ? std::atoi(argv[1]) : 4;
+    int nlines = argc >= 3 ? std::atoi(argv[2]) : 200000;
+    std::printf("%d threads, %d lines each\n", nthreads, nlines);
+    speedTest("stream", nthreads, nlines);
+    speedTest("printfln", nthreads, nlines);
+    speedTest("buffered", nthreads, nlines);
+    return 0;
+}